@@ -0,0 +1,20 @@
+/*
+	Block fill and compare routines implemented in fill.s; any length
+	and alignment.
+*/
+
+#ifndef FILL_H
+#define	FILL_H
+
+#include <stdint.h>
+
+// Like memset: every byte of dst gets the low 8 bits of byte
+extern void				FillBlock(void *dst, uint32_t byte, uint32_t bytes) ;
+
+// Repeats pattern's bytes, least significant first, starting at dst
+extern void				FillPattern(void *dst, uint32_t pattern, uint32_t bytes) ;
+
+// Index of the first byte where a and b differ, or -1 if none
+extern int32_t			CompareBlock(const void *a, const void *b, uint32_t bytes) ;
+
+#endif
@@ -0,0 +1,110 @@
+// Block fill and compare for any length and alignment.
+// FillBlock stores one byte value like memset; FillPattern repeats a
+// 32-bit pattern whose least significant byte lands at dst. Both store
+// head bytes until dst is word aligned, then eight registers at a time.
+// CompareBlock returns the index of the first byte where a and b differ
+// or -1 if they match, comparing a word at a time whenever a and b can
+// both be word aligned.
+
+	.syntax	unified
+	.cpu	cortex-m4
+	.text
+
+	.global	FillBlock
+	.thumb_func
+FillBlock:				// R0 = dst, R1 = byte, R2 = bytes
+	AND	R1,R1,0xFF
+	ORR	R1,R1,R1,LSL 8
+	ORR	R1,R1,R1,LSL 16		// replicate the byte; fall into FillPattern
+
+	.global	FillPattern
+	.thumb_func
+FillPattern:				// R0 = dst, R1 = pattern, R2 = bytes
+fhead:	TST	R0,3
+	IT	NE
+	CMPNE	R2,0
+	BEQ	fbody			// dst aligned or nothing left
+	STRB	R1,[R0],1
+	ROR	R1,R1,8			// next byte of the pattern to the bottom
+	SUBS	R2,R2,1
+	B	fhead
+fbody:	CMP	R2,32
+	BLO	fword			// less than one STM block
+	PUSH	{R4-R8}
+	MOV	R3,R1
+	MOV	R4,R1
+	MOV	R5,R1
+	MOV	R6,R1
+	MOV	R7,R1
+	MOV	R8,R1
+	MOV	R12,R1
+	SUBS	R2,R2,32
+floop:	STMIA	R0!,{R1,R3-R8,R12}	// 32 bytes per iteration
+	SUBS	R2,R2,32
+	BHS	floop
+	ADD	R2,R2,32		// 0-31 bytes left
+	POP	{R4-R8}
+fword:	SUBS	R2,R2,4
+	BLO	ftail
+fwloop:	STR	R1,[R0],4
+	SUBS	R2,R2,4
+	BHS	fwloop
+ftail:	ADDS	R2,R2,4			// 0-3 bytes left
+	BEQ	fdone
+fbyte:	STRB	R1,[R0],1
+	ROR	R1,R1,8
+	SUBS	R2,R2,1
+	BNE	fbyte
+fdone:	BX	LR
+
+	.global	CompareBlock
+	.thumb_func
+CompareBlock:				// R0 = a, R1 = b, R2 = bytes
+	PUSH	{R4}
+	MOV	R12,R0			// index = R0 - R12
+	EOR	R3,R0,R1
+	TST	R3,3
+	BNE	cbytes			// a & b can never both be word aligned
+chead:	TST	R0,3
+	IT	NE
+	CMPNE	R2,0
+	BEQ	cbody			// a aligned or nothing left
+	LDRB	R3,[R0],1
+	LDRB	R4,[R1],1
+	CMP	R3,R4
+	BNE	cdiff1
+	SUBS	R2,R2,1
+	B	chead
+cbody:	SUBS	R2,R2,4
+	BLO	ctail
+cloop:	LDR	R3,[R0],4
+	LDR	R4,[R1],4
+	CMP	R3,R4
+	BNE	cdiff4
+	SUBS	R2,R2,4
+	BHS	cloop
+ctail:	ADDS	R2,R2,4			// 0-3 bytes left
+cbytes:	CMP	R2,0
+	BEQ	csame
+cbloop:	LDRB	R3,[R0],1
+	LDRB	R4,[R1],1
+	CMP	R3,R4
+	BNE	cdiff1
+	SUBS	R2,R2,1
+	BNE	cbloop
+csame:	MVN	R0,0			// -1: no difference
+	POP	{R4}
+	BX	LR
+cdiff4:	EOR	R3,R3,R4		// lowest differing byte comes first
+	RBIT	R3,R3
+	CLZ	R3,R3
+	SUB	R0,R0,4
+	ADD	R0,R0,R3,LSR 3
+	SUB	R0,R0,R12
+	POP	{R4}
+	BX	LR
+cdiff1:	SUB	R0,R0,1
+	SUB	R0,R0,R12
+	POP	{R4}
+	BX	LR
+	.end
@@ -0,0 +1,264 @@
+/*
+	Fixed-point trigonometry and square roots.
+
+	The sine table covers one quarter wave in 256 steps; the other three
+	quadrants are reflections of it. The low 6 bits of the angle within a
+	quadrant interpolate between adjacent entries. Square roots are found
+	one result bit at a time using only shifts, adds and compares.
+
+	A host build with FIXMATH_BENCH defined reports the largest error of
+	SinQ15, CosQ15 and SqrtQ16 against libm, checks the integer roots
+	exactly either side of every perfect square and at random, and times
+	each function against sinf and sqrtf. Without it fixmath.c links
+	into other host programs (Lab 5's mesh.c) as a plain library:
+
+		gcc -O2 -DFIXMATH_BENCH -o fixmath fixmath.c harness.c -lm && ./fixmath
+*/
+
+#include <stdint.h>
+#include "fixmath.h"
+
+#ifdef FIXMATH_BENCH
+#include <stdio.h>
+#include <math.h>
+#include "harness.h"
+#endif
+
+#define	QUADRANT		0x4000
+#define	FRAC_BITS		6
+
+// sin(90 * k/256 degrees) in Q15; the last entry repeats so that
+// interpolation at exactly 90 degrees stays inside the table
+static const uint16_t	sine[258] =
+	{
+	    0,   201,   402,   603,   804,  1005,  1206,  1407,  1608,  1809,
+	 2009,  2210,  2411,  2611,  2811,  3012,  3212,  3412,  3612,  3812,
+	 4011,  4211,  4410,  4609,  4808,  5007,  5205,  5404,  5602,  5800,
+	 5998,  6195,  6393,  6590,  6787,  6983,  7180,  7376,  7571,  7767,
+	 7962,  8157,  8351,  8546,  8740,  8933,  9127,  9319,  9512,  9704,
+	 9896, 10088, 10279, 10469, 10660, 10850, 11039, 11228, 11417, 11605,
+	11793, 11980, 12167, 12354, 12540, 12725, 12910, 13095, 13279, 13463,
+	13646, 13828, 14010, 14192, 14373, 14553, 14733, 14912, 15091, 15269,
+	15447, 15624, 15800, 15976, 16151, 16326, 16500, 16673, 16846, 17018,
+	17190, 17361, 17531, 17700, 17869, 18037, 18205, 18372, 18538, 18703,
+	18868, 19032, 19195, 19358, 19520, 19681, 19841, 20001, 20160, 20318,
+	20475, 20632, 20788, 20943, 21097, 21251, 21403, 21555, 21706, 21856,
+	22006, 22154, 22302, 22449, 22595, 22740, 22884, 23028, 23170, 23312,
+	23453, 23593, 23732, 23870, 24008, 24144, 24279, 24414, 24548, 24680,
+	24812, 24943, 25073, 25202, 25330, 25457, 25583, 25708, 25833, 25956,
+	26078, 26199, 26320, 26439, 26557, 26674, 26791, 26906, 27020, 27133,
+	27246, 27357, 27467, 27576, 27684, 27791, 27897, 28002, 28106, 28209,
+	28311, 28411, 28511, 28610, 28707, 28803, 28899, 28993, 29086, 29178,
+	29269, 29359, 29448, 29535, 29622, 29707, 29792, 29875, 29957, 30038,
+	30118, 30196, 30274, 30350, 30425, 30499, 30572, 30644, 30715, 30784,
+	30853, 30920, 30986, 31050, 31114, 31177, 31238, 31298, 31357, 31415,
+	31471, 31527, 31581, 31634, 31686, 31737, 31786, 31834, 31881, 31927,
+	31972, 32015, 32058, 32099, 32138, 32177, 32214, 32251, 32286, 32319,
+	32352, 32383, 32413, 32442, 32470, 32496, 32522, 32546, 32568, 32590,
+	32610, 32629, 32647, 32664, 32679, 32693, 32706, 32718, 32729, 32738,
+	32746, 32753, 32758, 32762, 32766, 32767, 32768, 32768
+	} ;
+
+int32_t SinQ15(ANGLE angle)
+	{
+	uint32_t phase, index, frac ;
+	int32_t value ;
+
+	phase = angle & (QUADRANT - 1) ;
+	if (angle & QUADRANT) phase = QUADRANT - phase ;	// 2nd & 4th quadrants
+
+	index = phase >> FRAC_BITS ;
+	frac  = phase & ((1 << FRAC_BITS) - 1) ;
+	value = sine[index] + (((sine[index + 1] - sine[index]) * frac) >> FRAC_BITS) ;
+
+	return (angle & (2*QUADRANT)) ? -value : value ;	// 3rd & 4th quadrants
+	}
+
+int32_t CosQ15(ANGLE angle)
+	{
+	return SinQ15(angle + QUADRANT) ;
+	}
+
+uint32_t ISqrt(uint32_t radical)
+	{
+	uint32_t root, bit ;
+
+	root = 0 ;
+	bit = 1UL << 30 ;
+	while (bit > radical) bit >>= 2 ;
+	while (bit != 0)
+		{
+		if (radical >= root + bit)
+			{
+			radical -= root + bit ;
+			root = (root >> 1) + bit ;
+			}
+		else root >>= 1 ;
+		bit >>= 2 ;
+		}
+
+	return root ;
+	}
+
+uint32_t ISqrt64(uint64_t radical)
+	{
+	uint64_t root, bit ;
+
+	if (radical <= UINT32_MAX) return ISqrt(radical) ;
+
+	root = 0 ;
+	bit = 1ULL << 62 ;
+	while (bit > radical) bit >>= 2 ;
+	while (bit != 0)
+		{
+		if (radical >= root + bit)
+			{
+			radical -= root + bit ;
+			root = (root >> 1) + bit ;
+			}
+		else root >>= 1 ;
+		bit >>= 2 ;
+		}
+
+	return root ;
+	}
+
+uint32_t SqrtQ16(uint32_t radical)
+	{
+	// sqrt(r/2^16) * 2^16 = sqrt(r * 2^16)
+	return ISqrt64((uint64_t) radical << 16) ;
+	}
+
+#ifdef FIXMATH_BENCH
+
+#define	CALLS			65536
+#define	REPS			15
+#define	RANDOM			2000000
+
+static double			PerCall(void (*pass)(void)) ;
+static void				TimeCos(void) ;
+static void				TimeISqrt(void) ;
+static void				TimeISqrt64(void) ;
+static void				TimeSin(void) ;
+static void				TimeSinf(void) ;
+static void				TimeSqrtf(void) ;
+static void				TimeSqrtQ16(void) ;
+
+static volatile uint32_t sink ;
+
+// Nonzero unless root is the largest integer whose square is <= radical
+#define	WRONG_ROOT(root, radical)	\
+	((unsigned __int128) (root) * (root) > (radical) || ((unsigned __int128) (root) + 1) * ((unsigned __int128) (root) + 1) <= (radical))
+
+int main(void)
+	{
+	double error, sinErr, cosErr, sqrtErr, pi = 3.14159265358979 ;
+	uint32_t k, n, x, isqrtErrs, isqrt64Errs, sqrtQ16Errs ;
+	uint64_t y ;
+
+	// Trig: every angle against libm
+	sinErr = cosErr = 0 ;
+	for (k = 0; k < 0x10000; k++)
+		{
+		error = fabs(SinQ15(k) - 32768 * sin(2 * pi * k / 0x10000)) ;
+		if (error > sinErr) sinErr = error ;
+		error = fabs(CosQ15(k) - 32768 * cos(2 * pi * k / 0x10000)) ;
+		if (error > cosErr) cosErr = error ;
+		}
+
+	// Roots: either side of every perfect square, then random values
+	isqrtErrs = isqrt64Errs = sqrtQ16Errs = 0 ;
+	sqrtErr = 0 ;
+	for (k = 1; k <= 0xFFFF; k++)
+		{
+		for (n = 0; n < 3; n++)
+			{
+			x = k*k - 1 + n ;
+			isqrtErrs += WRONG_ROOT(ISqrt(x), x) ;
+			}
+		y = (uint64_t) k * 65537 ;				// Roots up to 2^32 - 1
+		for (n = 0; n < 3; n++)
+			{
+			isqrt64Errs += WRONG_ROOT(ISqrt64(y*y - 1 + n), y*y - 1 + n) ;
+			}
+		}
+	isqrtErrs += WRONG_ROOT(ISqrt(UINT32_MAX), UINT32_MAX) ;
+	isqrt64Errs += WRONG_ROOT(ISqrt64(UINT64_MAX), UINT64_MAX) ;
+	for (k = 0; k < RANDOM; k++)
+		{
+		y = HarnessRandom64() ;
+		x = (uint32_t) y ;
+		isqrtErrs += WRONG_ROOT(ISqrt(x), x) ;
+		isqrt64Errs += WRONG_ROOT(ISqrt64(y), y) ;
+		sqrtQ16Errs += WRONG_ROOT(SqrtQ16(x), (uint64_t) x << 16) ;
+		error = fabs(SqrtQ16(x) - 65536 * sqrt(x / 65536.0)) ;
+		if (error > sqrtErr) sqrtErr = error ;
+		}
+
+	printf("function,max error (LSB),wrong results,ns/call\n") ;
+	printf("SinQ15,%.2f,,%.2f\n", sinErr, PerCall(TimeSin)) ;
+	printf("CosQ15,%.2f,,%.2f\n", cosErr, PerCall(TimeCos)) ;
+	printf("ISqrt,,%u,%.2f\n", isqrtErrs, PerCall(TimeISqrt)) ;
+	printf("ISqrt64,,%u,%.2f\n", isqrt64Errs, PerCall(TimeISqrt64)) ;
+	printf("SqrtQ16,%.2f,%u,%.2f\n", sqrtErr, sqrtQ16Errs, PerCall(TimeSqrtQ16)) ;
+	printf("sinf (libm),,,%.2f\n", PerCall(TimeSinf)) ;
+	printf("sqrtf (libm),,,%.2f\n", PerCall(TimeSqrtf)) ;
+	return isqrtErrs + isqrt64Errs + sqrtQ16Errs != 0 || sinErr > 2 || cosErr > 2 ;
+	}
+
+// Shortest of REPS passes of CALLS calls
+static double PerCall(void (*pass)(void))
+	{
+	return (double) HarnessBest(pass, REPS) / CALLS ;
+	}
+
+static void TimeSin(void)
+	{
+	uint32_t k ;
+
+	for (k = 0; k < CALLS; k++) sink += SinQ15(k) ;
+	}
+
+static void TimeCos(void)
+	{
+	uint32_t k ;
+
+	for (k = 0; k < CALLS; k++) sink += CosQ15(k) ;
+	}
+
+static void TimeISqrt(void)
+	{
+	uint32_t k ;
+
+	for (k = 0; k < CALLS; k++) sink += ISqrt(k * 65521u) ;
+	}
+
+static void TimeISqrt64(void)
+	{
+	uint32_t k ;
+
+	for (k = 0; k < CALLS; k++) sink += ISqrt64(k * 0x9E3779B97F4A7C15ULL) ;
+	}
+
+static void TimeSqrtQ16(void)
+	{
+	uint32_t k ;
+
+	for (k = 0; k < CALLS; k++) sink += SqrtQ16(k * 65521u) ;
+	}
+
+static void TimeSinf(void)
+	{
+	uint32_t k ;
+
+	for (k = 0; k < CALLS; k++) sink += (uint32_t) (32768 * sinf(k * (float) (2 * 3.14159265358979 / 0x10000))) ;
+	}
+
+static void TimeSqrtf(void)
+	{
+	uint32_t k ;
+
+	for (k = 0; k < CALLS; k++) sink += (uint32_t) sqrtf(k * 65521.0f) ;
+	}
+
+#endif
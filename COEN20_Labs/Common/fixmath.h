@@ -0,0 +1,32 @@
+/*
+	Fixed-point trigonometry and square roots shared by the labs.
+
+	Angles are 16-bit binary angles: 0x10000 is one full turn, so 0x4000 is
+	90 degrees and an 8-bit value such as Lab 1's counter maps to an angle
+	by shifting it left 8 bits. Sines and cosines are Q15 (32768 = 1.0).
+*/
+
+#ifndef FIXMATH_H
+#define	FIXMATH_H
+
+#include <stdint.h>
+
+typedef uint16_t		ANGLE ;
+
+#define	Q15_ONE			32768
+#define	Q16_ONE			65536
+
+#define	ANGLE_DEG(d)	((ANGLE) (((d) * 65536L) / 360))
+
+// Quarter-wave table lookup with linear interpolation (error < 2 LSB)
+extern int32_t			SinQ15(ANGLE angle) ;
+extern int32_t			CosQ15(ANGLE angle) ;
+
+// Integer square roots, rounded down
+extern uint32_t			ISqrt(uint32_t radical) ;
+extern uint32_t			ISqrt64(uint64_t radical) ;
+
+// Square root of a non-negative Q16 number, result in Q16
+extern uint32_t			SqrtQ16(uint32_t radical) ;
+
+#endif
@@ -0,0 +1,47 @@
+/*
+	Host timing and random numbers for the test and benchmark mains.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include "harness.h"
+
+uint32_t HarnessTicks(void)
+	{
+	struct timespec ts ;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts) ;
+	return (uint32_t) (ts.tv_sec * 1000000000ULL + ts.tv_nsec) ;
+	}
+
+uint32_t HarnessBest(void (*pass)(void), uint32_t reps)
+	{
+	uint32_t rep, strt, ovhd, best ;
+
+	ovhd = best = UINT32_MAX ;
+	for (rep = 0; rep < reps; rep++)
+		{
+		strt = HarnessTicks() ;
+		strt = HarnessTicks() - strt ;
+		if (strt < ovhd) ovhd = strt ;
+		}
+	for (rep = 0; rep < reps; rep++)
+		{
+		strt = HarnessTicks() ;
+		(*pass)() ;
+		strt = HarnessTicks() - strt ;
+		if (strt < best) best = strt ;
+		}
+	return (best > ovhd) ? best - ovhd : 0 ;
+	}
+
+// Four rand() calls, each shifted 16 bits past the one before
+uint64_t HarnessRandom64(void)
+	{
+	uint64_t n = 0 ;
+	int k ;
+
+	for (k = 0; k < 4; k++) n = (n << 16) ^ (uint64_t) rand() ;
+	return n ;
+	}
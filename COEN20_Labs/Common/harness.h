@@ -0,0 +1,22 @@
+/*
+	Shared pieces of the host test and benchmark mains (BITPACK_BENCH,
+	BITCODEC_TEST, FORMAT_BENCH, FIXMATH_BENCH, MATRIX_TEST, MESH_BENCH
+	and the Lab 3 sweep). Host builds only: the clock is clock_gettime.
+	Each of those builds adds ../Common/harness.c (harness.c here).
+
+	HarnessTicks is nanoseconds in 32 bits, so a difference between two
+	readings is good for about four seconds. HarnessBest runs pass reps
+	times and returns the shortest run less the cost of reading the
+	clock.
+*/
+
+#ifndef HARNESS_H
+#define	HARNESS_H
+
+#include <stdint.h>
+
+extern uint32_t			HarnessTicks(void) ;
+extern uint32_t			HarnessBest(void (*pass)(void), uint32_t reps) ;
+extern uint64_t			HarnessRandom64(void) ;	// 64 bits from rand()
+
+#endif
@@ -0,0 +1,66 @@
+/*
+	Width-specialized codec for unpacked bit arrays (one int8_t per bit,
+	least significant bit first). BITCODEC(W) defines, for a bit width W
+	of 1 to 64:
+
+		uint64_t	Bits2Unsigned<W>(const int8_t bits[W])
+		int64_t		Bits2Signed<W>(const int8_t bits[W])
+		uint32_t	Increment<W>(int8_t bits[W])		returns the carry-out
+		void		Unsigned2Bits<W>(uint64_t n, int8_t bits[W])
+
+	Every loop has the constant trip count W, so the compiler unrolls each
+	instance completely. Instantiate only the widths a file needs, e.g.
+
+		BITCODEC(8)
+		BITCODEC(12)
+
+	lab1code.c built on a host with BITCODEC_TEST defined checks every
+	value of widths 1 to 16 and random values of wider ones up to 64:
+
+		gcc -O2 -DBITCODEC_TEST -I../Common -o bitcodec lab1code.c bitpack.c counters.c ../Common/harness.c && ./bitcodec
+*/
+
+#ifndef BITCODEC_H
+#define	BITCODEC_H
+
+#include <stdint.h>
+
+#define	BITCODEC_SIGN(W)	((uint64_t) 1 << ((W) - 1))
+
+#define	BITCODEC(W)																\
+static inline uint64_t Bits2Unsigned##W(const int8_t bits[W])					\
+	{																			\
+	uint64_t n = 0 ;															\
+	int k ;																		\
+	for (k = (W) - 1; k >= 0; k--) n = (n << 1) | (bits[k] & 1) ;				\
+	return n ;																	\
+	}																			\
+																				\
+static inline int64_t Bits2Signed##W(const int8_t bits[W])						\
+	{																			\
+	/* Sign extend by flipping, then removing, the sign bit */					\
+	uint64_t n = Bits2Unsigned##W(bits) ;										\
+	return (int64_t) ((n ^ BITCODEC_SIGN(W)) - BITCODEC_SIGN(W)) ;				\
+	}																			\
+																				\
+static inline uint32_t Increment##W(int8_t bits[W])								\
+	{																			\
+	/* Ripple the carry through every bit; no early exit */						\
+	uint32_t carry = 1, sum ;													\
+	int k ;																		\
+	for (k = 0; k < (W); k++)													\
+		{																		\
+		sum = (bits[k] & 1) + carry ;											\
+		bits[k] = sum & 1 ;														\
+		carry = sum >> 1 ;														\
+		}																		\
+	return carry ;																\
+	}																			\
+																				\
+static inline void Unsigned2Bits##W(uint64_t n, int8_t bits[W])					\
+	{																			\
+	int k ;																		\
+	for (k = 0; k < (W); k++) bits[k] = (n >> k) & 1 ;							\
+	}
+
+#endif
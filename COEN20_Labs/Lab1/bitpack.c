@@ -0,0 +1,266 @@
+/*
+	Batch conversion between unpacked bit arrays and packed bytes/words.
+
+	Packing gathers four bits at a time with one 32-bit multiply: each bit
+	is shifted into the top byte of the product by its own partial product,
+	and the remaining partial products never carry into that byte.
+	Unpacking spreads a nibble at a time through a 16-entry table. Both
+	directions assume a little-endian target (Cortex-M4, x86 hosts).
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include "bitpack.h"
+
+#ifdef BITPACK_BENCH
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "harness.h"
+#endif
+
+static uint32_t			Gather4(const int8_t bits[]) ;
+static void				Spread8(int8_t bits[], uint32_t byte) ;
+
+// Four unpacked bits (one per byte, LSB first) for each nibble value
+static const uint32_t	spread[16] =
+	{
+	0x00000000, 0x00000001, 0x00000100, 0x00000101,
+	0x00010000, 0x00010001, 0x00010100, 0x00010101,
+	0x01000000, 0x01000001, 0x01000100, 0x01000101,
+	0x01010000, 0x01010001, 0x01010100, 0x01010101
+	} ;
+
+void PackBits(uint8_t bytes[], const int8_t bits[], uint32_t count)
+	{
+	uint32_t k ;
+
+	for (k = 0; k < count; k++, bits += 8)
+		{
+		*bytes++ = Gather4(bits) | (Gather4(bits + 4) << 4) ;
+		}
+	}
+
+void UnpackBits(int8_t bits[], const uint8_t bytes[], uint32_t count)
+	{
+	uint32_t k ;
+
+	for (k = 0; k < count; k++, bits += 8)
+		{
+		Spread8(bits, *bytes++) ;
+		}
+	}
+
+void PackBits16(uint16_t words[], const int8_t bits[], uint32_t count)
+	{
+	uint32_t k ;
+
+	for (k = 0; k < count; k++, bits += 16)
+		{
+		uint8_t bytes[2] ;
+
+		PackBits(bytes, bits, 2) ;
+		*words++ = bytes[0] | (bytes[1] << 8) ;
+		}
+	}
+
+void PackBits32(uint32_t words[], const int8_t bits[], uint32_t count)
+	{
+	uint32_t k ;
+
+	for (k = 0; k < count; k++, bits += 32)
+		{
+		uint8_t bytes[4] ;
+
+		PackBits(bytes, bits, 4) ;
+		*words++ = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t) bytes[3] << 24) ;
+		}
+	}
+
+void PackBits64(uint64_t words[], const int8_t bits[], uint32_t count)
+	{
+	uint32_t k, lo, hi ;
+
+	for (k = 0; k < count; k++)
+		{
+		PackBits32(&lo, bits, 1) ; bits += 32 ;
+		PackBits32(&hi, bits, 1) ; bits += 32 ;
+		*words++ = ((uint64_t) hi << 32) | lo ;
+		}
+	}
+
+void UnpackBits16(int8_t bits[], const uint16_t words[], uint32_t count)
+	{
+	uint32_t k ;
+
+	for (k = 0; k < count; k++, words++)
+		{
+		Spread8(bits,     *words & 0xFF) ;
+		Spread8(bits + 8, *words >> 8) ;
+		bits += 16 ;
+		}
+	}
+
+void UnpackBits32(int8_t bits[], const uint32_t words[], uint32_t count)
+	{
+	uint32_t k, word ;
+
+	for (k = 0; k < count; k++)
+		{
+		word = *words++ ;
+		Spread8(bits,      word & 0xFF) ;
+		Spread8(bits +  8, (word >>  8) & 0xFF) ;
+		Spread8(bits + 16, (word >> 16) & 0xFF) ;
+		Spread8(bits + 24, word >> 24) ;
+		bits += 32 ;
+		}
+	}
+
+void UnpackBits64(int8_t bits[], const uint64_t words[], uint32_t count)
+	{
+	uint32_t k, half[2] ;
+
+	for (k = 0; k < count; k++, words++)
+		{
+		half[0] = (uint32_t) *words ;
+		half[1] = (uint32_t) (*words >> 32) ;
+		UnpackBits32(bits, half, 2) ;
+		bits += 64 ;
+		}
+	}
+
+static uint32_t Gather4(const int8_t bits[])
+	{
+	uint32_t word ;
+
+	// Bit k of the result comes from byte k of the word
+	memcpy(&word, bits, sizeof(word)) ;
+	return ((word & 0x01010101) * 0x01020408) >> 24 ;
+	}
+
+static void Spread8(int8_t bits[], uint32_t byte)
+	{
+	memcpy(bits,     &spread[byte & 0xF], sizeof(uint32_t)) ;
+	memcpy(bits + 4, &spread[byte >> 4],  sizeof(uint32_t)) ;
+	}
+
+#ifdef BITPACK_BENCH
+
+#define	BYTES			4096
+#define	REPS			31
+
+static void				Pack(void) ;
+static double			PerByte(void (*pass)(void)) ;
+static uint32_t			PowBits2Unsigned(const int8_t bits[8]) ;
+static void				PowPack(void) ;
+static void				PowUnpack(void) ;
+static void				PowUnsigned2Bits(uint32_t n, int8_t bits[8]) ;
+static void				Unpack(void) ;
+
+static int8_t			bits[64*BYTES], again[64*BYTES] ;
+static uint8_t			bytes[BYTES], check[BYTES] ;
+static uint16_t			w16[4*BYTES] ;
+static uint32_t			w32[2*BYTES] ;
+static uint64_t			w64[BYTES] ;
+
+int main(void)
+	{
+	uint32_t k, bit ;
+	int errors = 0 ;
+
+	// Every byte value both ways against the original loops
+	for (k = 0; k < 256; k++) bytes[k] = k ;
+	UnpackBits(bits, bytes, 256) ;
+	for (k = 0; k < 256; k++)
+		{
+		PowUnsigned2Bits(k, again + 8*k) ;
+		if (memcmp(bits + 8*k, again + 8*k, 8) != 0) printf("UnpackBits failed for %u\n", k), errors++ ;
+		}
+	PackBits(check, again, 256) ;
+	for (k = 0; k < 256; k++)
+		{
+		if (check[k] != PowBits2Unsigned(again + 8*k)) printf("PackBits failed for %u\n", k), errors++ ;
+		}
+
+	// Random words: bit k of the packed words is bits[k]
+	for (k = 0; k < 64*BYTES; k++) bits[k] = rand() & 1 ;
+	PackBits16(w16, bits, 4*BYTES) ;
+	PackBits32(w32, bits, 2*BYTES) ;
+	PackBits64(w64, bits, BYTES) ;
+	for (bit = 0; bit < 64*BYTES; bit++)
+		{
+		if (((w16[bit/16] >> (bit % 16)) & 1) != (uint32_t) bits[bit]) errors++ ;
+		if (((w32[bit/32] >> (bit % 32)) & 1) != (uint32_t) bits[bit]) errors++ ;
+		if (((w64[bit/64] >> (bit % 64)) & 1) != (uint64_t) bits[bit]) errors++ ;
+		}
+	UnpackBits16(again, w16, 4*BYTES) ;
+	errors += memcmp(bits, again, sizeof(bits)) != 0 ;
+	UnpackBits32(again, w32, 2*BYTES) ;
+	errors += memcmp(bits, again, sizeof(bits)) != 0 ;
+	UnpackBits64(again, w64, BYTES) ;
+	errors += memcmp(bits, again, sizeof(bits)) != 0 ;
+	printf("%d errors\n\n", errors) ;
+
+	printf("conversion,ns/byte\n") ;
+	printf("Bits2Unsigned (pow),%.2f\n", PerByte(PowPack)) ;
+	printf("PackBits,%.2f\n", PerByte(Pack)) ;
+	printf("Unsigned2Bits (pow),%.2f\n", PerByte(PowUnpack)) ;
+	printf("UnpackBits,%.2f\n", PerByte(Unpack)) ;
+	return errors != 0 ;
+	}
+
+// Shortest of REPS passes over BYTES bytes
+static double PerByte(void (*pass)(void))
+	{
+	return (double) HarnessBest(pass, REPS) / BYTES ;
+	}
+
+static void Pack(void)
+	{
+	PackBits(check, bits, BYTES) ;
+	}
+
+static void Unpack(void)
+	{
+	UnpackBits(again, bytes, BYTES) ;
+	}
+
+static void PowPack(void)
+	{
+	uint32_t k ;
+
+	for (k = 0; k < BYTES; k++) check[k] = PowBits2Unsigned(bits + 8*k) ;
+	}
+
+static void PowUnpack(void)
+	{
+	uint32_t k ;
+
+	for (k = 0; k < BYTES; k++) PowUnsigned2Bits(bytes[k], again + 8*k) ;
+	}
+
+// The per-byte conversions Lab 1 used before, one pow(2,i) per bit
+static uint32_t PowBits2Unsigned(const int8_t bits[8])
+	{
+	int k, ans = 0 ;
+
+	for (k = 7; k >= 0; k--) ans = ans + pow(2, k)*bits[k] ;
+	return ans ;
+	}
+
+static void PowUnsigned2Bits(uint32_t n, int8_t bits[8])
+	{
+	int k ;
+
+	for (k = 7; k >= 0; k--)
+		{
+		if (pow(2, k) > n) bits[k] = 0 ;
+		else
+			{
+			bits[k] = 1 ;
+			n = n - pow(2, k) ;
+			}
+		}
+	}
+
+#endif
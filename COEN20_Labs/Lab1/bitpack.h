@@ -0,0 +1,31 @@
+/*
+	Batch conversion between unpacked bit arrays (one int8_t per bit, least
+	significant bit first, as used by Lab 1) and packed bytes and words.
+
+	A host build of bitpack.c with BITPACK_BENCH defined checks every
+	byte value against the pow(2,i) loops Lab 1 used to have and random
+	bits through each word size, then reports time per byte for each,
+	like the Lab 3 harness. Without it bitpack.c links into other host
+	programs as a plain library:
+
+		gcc -O2 -DBITPACK_BENCH -I../Common -o bitpack bitpack.c ../Common/harness.c -lm && ./bitpack
+*/
+
+#ifndef BITPACK_H
+#define	BITPACK_H
+
+#include <stdint.h>
+
+// Unpacked bits <--> packed bytes (8 bits per byte)
+extern void		PackBits(uint8_t bytes[], const int8_t bits[], uint32_t count) ;
+extern void		UnpackBits(int8_t bits[], const uint8_t bytes[], uint32_t count) ;
+
+// Unpacked bits <--> packed words (16, 32 or 64 bits per word)
+extern void		PackBits16(uint16_t words[], const int8_t bits[], uint32_t count) ;
+extern void		PackBits32(uint32_t words[], const int8_t bits[], uint32_t count) ;
+extern void		PackBits64(uint64_t words[], const int8_t bits[], uint32_t count) ;
+extern void		UnpackBits16(int8_t bits[], const uint16_t words[], uint32_t count) ;
+extern void		UnpackBits32(int8_t bits[], const uint32_t words[], uint32_t count) ;
+extern void		UnpackBits64(int8_t bits[], const uint64_t words[], uint32_t count) ;
+
+#endif
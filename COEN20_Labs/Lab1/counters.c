@@ -0,0 +1,77 @@
+/*
+	Constant-time increment of packed counters.
+
+	Adding one to the low bits of every lane cannot carry across a lane
+	boundary; the lane's top bit is then toggled back in with XOR. A lane
+	carried out if its top bit went from 1 to 0, and overflowed as a signed
+	number if its top bit went from 0 to 1.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include "bitpack.h"
+#include "counters.h"
+
+#define	MSB8			0x80808080
+#define	ONE8			0x01010101
+
+#define	MSB16			0x80008000
+#define	ONE16			0x00010001
+
+static uint32_t			IncrementLanes(uint32_t counters[], uint32_t words, uint32_t carries[], uint32_t overflows[], uint32_t msb, uint32_t one) ;
+
+uint32_t IncrementLanes8(uint32_t counters[], uint32_t words, uint32_t carries[], uint32_t overflows[])
+	{
+	return IncrementLanes(counters, words, carries, overflows, MSB8, ONE8) ;
+	}
+
+uint32_t IncrementLanes16(uint32_t counters[], uint32_t words, uint32_t carries[], uint32_t overflows[])
+	{
+	return IncrementLanes(counters, words, carries, overflows, MSB16, ONE16) ;
+	}
+
+uint32_t IncrementByte(uint8_t *counter)
+	{
+	uint32_t old, new ;
+
+	old = *counter ;
+	new = (old + 1) & 0xFF ;
+	*counter = new ;
+
+	return ((old & ~new & 0x80) >> 7) * INC_CARRY | ((~old & new & 0x80) >> 7) * INC_OVERFLOW ;
+	}
+
+uint32_t IncrementBits8(int8_t bits[8])
+	{
+	uint32_t flags ;
+	uint8_t byte ;
+
+	PackBits(&byte, bits, 1) ;
+	flags = IncrementByte(&byte) ;
+	UnpackBits(bits, &byte, 1) ;
+
+	return flags ;
+	}
+
+static uint32_t IncrementLanes(uint32_t counters[], uint32_t words, uint32_t carries[], uint32_t overflows[], uint32_t msb, uint32_t one)
+	{
+	uint32_t old, new, carry, ovfl, anyCarry, anyOvfl, k ;
+
+	anyCarry = anyOvfl = 0 ;
+	for (k = 0; k < words; k++)
+		{
+		old = counters[k] ;
+		new = ((old & ~msb) + one) ^ (old & msb) ;
+		counters[k] = new ;
+
+		carry = old & ~new & msb ;
+		ovfl  = ~old & new & msb ;
+		if (carries   != NULL) carries[k]   = carry ;
+		if (overflows != NULL) overflows[k] = ovfl ;
+
+		anyCarry |= carry ;
+		anyOvfl  |= ovfl ;
+		}
+
+	return (anyCarry != 0) * INC_CARRY | (anyOvfl != 0) * INC_OVERFLOW ;
+	}
@@ -0,0 +1,28 @@
+/*
+	Constant-time increment of packed 8- and 16-bit counters. Several
+	counters share each 32-bit word (SWAR: SIMD within a register), so one
+	add advances them all and no carry leaks from one counter into the next.
+*/
+
+#ifndef COUNTERS_H
+#define	COUNTERS_H
+
+#include <stdint.h>
+
+// Flags returned by the increment functions
+#define	INC_CARRY		(1 << 0)	// unsigned wrap-around (all ones --> zero)
+#define	INC_OVERFLOW	(1 << 1)	// signed overflow (most positive --> most negative)
+
+// Four 8-bit counters per word. The per-word carry and overflow masks
+// (0x80 set in each lane that wrapped) are stored if the pointers are
+// not NULL. Returns the INC_ flags of all counters combined.
+extern uint32_t	IncrementLanes8(uint32_t counters[], uint32_t words, uint32_t carries[], uint32_t overflows[]) ;
+
+// Two 16-bit counters per word (0x8000 set in each lane that wrapped)
+extern uint32_t	IncrementLanes16(uint32_t counters[], uint32_t words, uint32_t carries[], uint32_t overflows[]) ;
+
+// A single packed 8-bit counter, and the same for an unpacked bit array
+extern uint32_t	IncrementByte(uint8_t *counter) ;
+extern uint32_t	IncrementBits8(int8_t bits[8]) ;
+
+#endif
@@ -0,0 +1,121 @@
+/*
+	Dirty-rectangle bookkeeping.
+
+	A new rectangle absorbs every stored rectangle it overlaps, so stored
+	rectangles never overlap one another. When the list is full the new
+	rectangle is merged into whichever stored one grows the least.
+*/
+
+#include <stdint.h>
+#include "damage.h"
+
+#define	MIN(a,b)		((a) < (b) ? (a) : (b))
+#define	MAX(a,b)		((a) > (b) ? (a) : (b))
+
+static uint32_t			Area(RECT *r) ;
+static void				Insert(DAMAGE *damage, RECT *rect) ;
+static int				Overlap(RECT *r1, RECT *r2) ;
+static void				Union(RECT *dst, RECT *src) ;
+
+void DamageReset(DAMAGE *damage)
+	{
+	damage->count = 0 ;
+	}
+
+void DamageAdd(DAMAGE *damage, int32_t x, int32_t y, int32_t width, int32_t height)
+	{
+	RECT rect ;
+
+	if (width <= 0 || height <= 0) return ;
+	rect.xmin = x ;
+	rect.ymin = y ;
+	rect.xmax = x + width - 1 ;
+	rect.ymax = y + height - 1 ;
+	Insert(damage, &rect) ;
+	}
+
+int DamageTouches(DAMAGE *damage, int32_t x, int32_t y, int32_t width, int32_t height)
+	{
+	RECT rect ;
+	uint32_t k ;
+
+	rect.xmin = x ;
+	rect.ymin = y ;
+	rect.xmax = x + width - 1 ;
+	rect.ymax = y + height - 1 ;
+	for (k = 0; k < damage->count; k++)
+		{
+		if (Overlap(&rect, &damage->rects[k])) return 1 ;
+		}
+	return 0 ;
+	}
+
+uint32_t DamagePixels(DAMAGE *damage)
+	{
+	uint32_t k, pixels ;
+
+	pixels = 0 ;
+	for (k = 0; k < damage->count; k++)
+		{
+		pixels += Area(&damage->rects[k]) ;
+		}
+	return pixels ;
+	}
+
+static uint32_t Area(RECT *r)
+	{
+	return (r->xmax - r->xmin + 1) * (r->ymax - r->ymin + 1) ;
+	}
+
+static void Insert(DAMAGE *damage, RECT *rect)
+	{
+	uint32_t k, best, growth, least ;
+	RECT test ;
+
+	for (;;)
+		{
+		// Absorb (and remove) every stored rectangle that overlaps; the
+		// grown rectangle may now overlap ones already checked, so restart
+		for (k = 0; k < damage->count; k++)
+			{
+			if (!Overlap(rect, &damage->rects[k])) continue ;
+			Union(rect, &damage->rects[k]) ;
+			damage->rects[k] = damage->rects[--damage->count] ;
+			k = -1 ;
+			}
+
+		if (damage->count < DAMAGE_RECTS)
+			{
+			damage->rects[damage->count++] = *rect ;
+			return ;
+			}
+
+		// List is full: merge with the rectangle that grows the least,
+		// then go round again since the result may overlap others
+		best = 0 ;
+		least = UINT32_MAX ;
+		for (k = 0; k < damage->count; k++)
+			{
+			test = damage->rects[k] ;
+			Union(&test, rect) ;
+			growth = Area(&test) - Area(&damage->rects[k]) ;
+			if (growth < least) { least = growth ; best = k ; }
+			}
+		Union(rect, &damage->rects[best]) ;
+		damage->rects[best] = damage->rects[--damage->count] ;
+		}
+	}
+
+static int Overlap(RECT *r1, RECT *r2)
+	{
+	return r1->xmin <= r2->xmax && r2->xmin <= r1->xmax
+		&& r1->ymin <= r2->ymax && r2->ymin <= r1->ymax ;
+	}
+
+static void Union(RECT *dst, RECT *src)
+	{
+	dst->xmin = MIN(dst->xmin, src->xmin) ;
+	dst->ymin = MIN(dst->ymin, src->ymin) ;
+	dst->xmax = MAX(dst->xmax, src->xmax) ;
+	dst->ymax = MAX(dst->ymax, src->ymax) ;
+	}
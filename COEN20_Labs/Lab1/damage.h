@@ -0,0 +1,36 @@
+/*
+	Damage tracking for the Lab 1 indicators. Widgets report the screen
+	rectangles they are about to change; overlapping rectangles are merged
+	into their bounding box so that the list always holds a set of
+	disjoint regions. Their total area is an upper bound on the pixels
+	written this frame: a widget's rectangle and a merged box can both
+	take in pixels that were never drawn.
+*/
+
+#ifndef DAMAGE_H
+#define	DAMAGE_H
+
+#include <stdint.h>
+
+#define	DAMAGE_RECTS	8
+
+typedef struct
+	{
+	int32_t				xmin ;
+	int32_t				ymin ;
+	int32_t				xmax ;	// inclusive
+	int32_t				ymax ;	// inclusive
+	} RECT ;
+
+typedef struct
+	{
+	uint32_t			count ;
+	RECT				rects[DAMAGE_RECTS] ;
+	} DAMAGE ;
+
+extern void				DamageReset(DAMAGE *damage) ;
+extern void				DamageAdd(DAMAGE *damage, int32_t x, int32_t y, int32_t width, int32_t height) ;
+extern int				DamageTouches(DAMAGE *damage, int32_t x, int32_t y, int32_t width, int32_t height) ;
+extern uint32_t			DamagePixels(DAMAGE *damage) ;	// At most this many written
+
+#endif
@@ -0,0 +1,293 @@
+/*
+	Bulk binary and hexadecimal formatting.
+
+	Each byte is rendered with a single table lookup: eight characters from
+	the binary table or two from the hex table. Wider values are rendered a
+	byte at a time, most significant byte first.
+
+	The tables are indexed by a whole byte rather than a nibble. A nibble
+	table hit yields only four binary characters, so eight characters per
+	hit needs the byte: 2 KB of binary text and 512 bytes of hex in flash,
+	against 64 + 32 for nibble tables, for half the lookups and shifts.
+
+	A host build with FORMAT_BENCH defined checks the output against the
+	per-bit loop Lab 1 used (Bin2Asc) and printf, then reports time per
+	byte for each:
+
+		gcc -O2 -DFORMAT_BENCH -I../Common -o format format.c ../Common/harness.c && ./format
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include "format.h"
+
+#ifdef FORMAT_BENCH
+#include <stdio.h>
+#include "harness.h"
+#endif
+
+static uint32_t			Fetch(const void *values, uint32_t index, uint32_t bits) ;
+
+static const char		binary[256][8] =
+	{
+	"00000000", "00000001", "00000010", "00000011",
+	"00000100", "00000101", "00000110", "00000111",
+	"00001000", "00001001", "00001010", "00001011",
+	"00001100", "00001101", "00001110", "00001111",
+	"00010000", "00010001", "00010010", "00010011",
+	"00010100", "00010101", "00010110", "00010111",
+	"00011000", "00011001", "00011010", "00011011",
+	"00011100", "00011101", "00011110", "00011111",
+	"00100000", "00100001", "00100010", "00100011",
+	"00100100", "00100101", "00100110", "00100111",
+	"00101000", "00101001", "00101010", "00101011",
+	"00101100", "00101101", "00101110", "00101111",
+	"00110000", "00110001", "00110010", "00110011",
+	"00110100", "00110101", "00110110", "00110111",
+	"00111000", "00111001", "00111010", "00111011",
+	"00111100", "00111101", "00111110", "00111111",
+	"01000000", "01000001", "01000010", "01000011",
+	"01000100", "01000101", "01000110", "01000111",
+	"01001000", "01001001", "01001010", "01001011",
+	"01001100", "01001101", "01001110", "01001111",
+	"01010000", "01010001", "01010010", "01010011",
+	"01010100", "01010101", "01010110", "01010111",
+	"01011000", "01011001", "01011010", "01011011",
+	"01011100", "01011101", "01011110", "01011111",
+	"01100000", "01100001", "01100010", "01100011",
+	"01100100", "01100101", "01100110", "01100111",
+	"01101000", "01101001", "01101010", "01101011",
+	"01101100", "01101101", "01101110", "01101111",
+	"01110000", "01110001", "01110010", "01110011",
+	"01110100", "01110101", "01110110", "01110111",
+	"01111000", "01111001", "01111010", "01111011",
+	"01111100", "01111101", "01111110", "01111111",
+	"10000000", "10000001", "10000010", "10000011",
+	"10000100", "10000101", "10000110", "10000111",
+	"10001000", "10001001", "10001010", "10001011",
+	"10001100", "10001101", "10001110", "10001111",
+	"10010000", "10010001", "10010010", "10010011",
+	"10010100", "10010101", "10010110", "10010111",
+	"10011000", "10011001", "10011010", "10011011",
+	"10011100", "10011101", "10011110", "10011111",
+	"10100000", "10100001", "10100010", "10100011",
+	"10100100", "10100101", "10100110", "10100111",
+	"10101000", "10101001", "10101010", "10101011",
+	"10101100", "10101101", "10101110", "10101111",
+	"10110000", "10110001", "10110010", "10110011",
+	"10110100", "10110101", "10110110", "10110111",
+	"10111000", "10111001", "10111010", "10111011",
+	"10111100", "10111101", "10111110", "10111111",
+	"11000000", "11000001", "11000010", "11000011",
+	"11000100", "11000101", "11000110", "11000111",
+	"11001000", "11001001", "11001010", "11001011",
+	"11001100", "11001101", "11001110", "11001111",
+	"11010000", "11010001", "11010010", "11010011",
+	"11010100", "11010101", "11010110", "11010111",
+	"11011000", "11011001", "11011010", "11011011",
+	"11011100", "11011101", "11011110", "11011111",
+	"11100000", "11100001", "11100010", "11100011",
+	"11100100", "11100101", "11100110", "11100111",
+	"11101000", "11101001", "11101010", "11101011",
+	"11101100", "11101101", "11101110", "11101111",
+	"11110000", "11110001", "11110010", "11110011",
+	"11110100", "11110101", "11110110", "11110111",
+	"11111000", "11111001", "11111010", "11111011",
+	"11111100", "11111101", "11111110", "11111111"
+	} ;
+
+static const char		hex[256][2] =
+	{
+	"00", "01", "02", "03", "04", "05", "06", "07", "08", "09", "0A", "0B", "0C", "0D", "0E", "0F",
+	"10", "11", "12", "13", "14", "15", "16", "17", "18", "19", "1A", "1B", "1C", "1D", "1E", "1F",
+	"20", "21", "22", "23", "24", "25", "26", "27", "28", "29", "2A", "2B", "2C", "2D", "2E", "2F",
+	"30", "31", "32", "33", "34", "35", "36", "37", "38", "39", "3A", "3B", "3C", "3D", "3E", "3F",
+	"40", "41", "42", "43", "44", "45", "46", "47", "48", "49", "4A", "4B", "4C", "4D", "4E", "4F",
+	"50", "51", "52", "53", "54", "55", "56", "57", "58", "59", "5A", "5B", "5C", "5D", "5E", "5F",
+	"60", "61", "62", "63", "64", "65", "66", "67", "68", "69", "6A", "6B", "6C", "6D", "6E", "6F",
+	"70", "71", "72", "73", "74", "75", "76", "77", "78", "79", "7A", "7B", "7C", "7D", "7E", "7F",
+	"80", "81", "82", "83", "84", "85", "86", "87", "88", "89", "8A", "8B", "8C", "8D", "8E", "8F",
+	"90", "91", "92", "93", "94", "95", "96", "97", "98", "99", "9A", "9B", "9C", "9D", "9E", "9F",
+	"A0", "A1", "A2", "A3", "A4", "A5", "A6", "A7", "A8", "A9", "AA", "AB", "AC", "AD", "AE", "AF",
+	"B0", "B1", "B2", "B3", "B4", "B5", "B6", "B7", "B8", "B9", "BA", "BB", "BC", "BD", "BE", "BF",
+	"C0", "C1", "C2", "C3", "C4", "C5", "C6", "C7", "C8", "C9", "CA", "CB", "CC", "CD", "CE", "CF",
+	"D0", "D1", "D2", "D3", "D4", "D5", "D6", "D7", "D8", "D9", "DA", "DB", "DC", "DD", "DE", "DF",
+	"E0", "E1", "E2", "E3", "E4", "E5", "E6", "E7", "E8", "E9", "EA", "EB", "EC", "ED", "EE", "EF",
+	"F0", "F1", "F2", "F3", "F4", "F5", "F6", "F7", "F8", "F9", "FA", "FB", "FC", "FD", "FE", "FF"
+	} ;
+
+uint32_t FormatBinary(char *bfr, const void *values, uint32_t count, uint32_t bits, char sep)
+	{
+	uint32_t k, value, shift ;
+	char *p = bfr ;
+
+	for (k = 0; k < count; k++)
+		{
+		if (k != 0 && sep != '\0') *p++ = sep ;
+		value = Fetch(values, k, bits) ;
+		for (shift = bits; shift != 0; shift -= 8)
+			{
+			memcpy(p, binary[(value >> (shift - 8)) & 0xFF], 8) ;
+			p += 8 ;
+			}
+		}
+	*p = '\0' ;
+
+	return p - bfr ;
+	}
+
+uint32_t FormatHex(char *bfr, const void *values, uint32_t count, uint32_t bits, char sep)
+	{
+	uint32_t k, value, shift ;
+	char *p = bfr ;
+
+	for (k = 0; k < count; k++)
+		{
+		if (k != 0 && sep != '\0') *p++ = sep ;
+		value = Fetch(values, k, bits) ;
+		for (shift = bits; shift != 0; shift -= 8)
+			{
+			memcpy(p, hex[(value >> (shift - 8)) & 0xFF], 2) ;
+			p += 2 ;
+			}
+		}
+	*p = '\0' ;
+
+	return p - bfr ;
+	}
+
+uint32_t FormatGrouped(char *bfr, const void *values, uint32_t count, uint32_t bits, uint32_t group, char sep)
+	{
+	uint32_t k, value, shift, done ;
+	const char *chars ;
+	char *p = bfr ;
+
+	for (k = 0; k < count; k++)
+		{
+		if (k != 0 && sep != '\0') *p++ = sep ;
+		value = Fetch(values, k, bits) ;
+		done = 0 ;
+		for (shift = bits; shift != 0; shift -= 8)
+			{
+			chars = binary[(value >> (shift - 8)) & 0xFF] ;
+			if (group == 4)
+				{
+				memcpy(p, chars, 4) ; p += 4 ;
+				*p++ = ' ' ;
+				memcpy(p, chars + 4, 4) ; p += 4 ;
+				}
+			else
+				{
+				memcpy(p, chars, 8) ; p += 8 ;
+				}
+			done += 8 ;
+			if (shift != 8 && done % group == 0) *p++ = ' ' ;
+			}
+		}
+	*p = '\0' ;
+
+	return p - bfr ;
+	}
+
+static uint32_t Fetch(const void *values, uint32_t index, uint32_t bits)
+	{
+	switch (bits)
+		{
+		case 8:		return ((const uint8_t *)  values)[index] ;
+		case 16:	return ((const uint16_t *) values)[index] ;
+		default:	return ((const uint32_t *) values)[index] ;
+		}
+	}
+
+#ifdef FORMAT_BENCH
+
+#define	VALUES			4096
+#define	REPS			31
+
+static const char *		Bin2Asc(uint32_t binary) ;
+static void				Fast(void) ;
+static double			PerByte(void (*pass)(void)) ;
+static void				Slow(void) ;
+
+static uint8_t			values[VALUES] ;
+static char				text[9*VALUES + 1] ;
+
+int main(void)
+	{
+	uint32_t k, words[2] = {0x12345678, 0x9ABCDEF0} ;
+	char expect[100] ;
+	int errors = 0 ;
+
+	for (k = 0; k < VALUES; k++) values[k] = k ;
+
+	// Every byte against the per-bit loop and against printf
+	FormatBinary(text, values, 256, 8, ' ') ;
+	for (k = 0; k < 256; k++)
+		{
+		if (memcmp(text + 9*k, Bin2Asc(k), 8) != 0) printf("FormatBinary failed for %u\n", k), errors++ ;
+		}
+	FormatHex(text, values, 256, 8, '\0') ;
+	for (k = 0; k < 256; k++)
+		{
+		sprintf(expect, "%02X", k) ;
+		if (memcmp(text + 2*k, expect, 2) != 0) printf("FormatHex failed for %u\n", k), errors++ ;
+		}
+
+	// Wider values, separators and groups
+	FormatHex(text, words, 2, 32, ',') ;
+	if (strcmp(text, "12345678,9ABCDEF0") != 0) printf("FormatHex 32: %s\n", text), errors++ ;
+	FormatGrouped(text, words, 1, 32, 4, '\0') ;
+	if (strcmp(text, "0001 0010 0011 0100 0101 0110 0111 1000") != 0) printf("FormatGrouped 4: %s\n", text), errors++ ;
+	FormatGrouped(text, words, 1, 32, 16, '\0') ;
+	if (strcmp(text, "0001001000110100 0101011001111000") != 0) printf("FormatGrouped 16: %s\n", text), errors++ ;
+	if (FormatBinary(text, words, 2, 16, '|') != 33) printf("FormatBinary 16: %s\n", text), errors++ ;
+	printf("%d errors\n\n", errors) ;
+
+	printf("formatter,ns/byte\n") ;
+	printf("Bin2Asc,%.2f\n", PerByte(Slow)) ;
+	printf("FormatBinary,%.2f\n", PerByte(Fast)) ;
+	return errors != 0 ;
+	}
+
+// Shortest of REPS passes over VALUES bytes
+static double PerByte(void (*pass)(void))
+	{
+	return (double) HarnessBest(pass, REPS) / VALUES ;
+	}
+
+static void Fast(void)
+	{
+	FormatBinary(text, values, VALUES, 8, ' ') ;
+	}
+
+// One byte at a time through Bin2Asc, copied out as Lab 1 would
+static void Slow(void)
+	{
+	uint32_t k ;
+	char *p = text ;
+
+	for (k = 0; k < VALUES; k++)
+		{
+		if (k != 0) *p++ = ' ' ;
+		memcpy(p, Bin2Asc(values[k]), 8) ;
+		p += 8 ;
+		}
+	*p = '\0' ;
+	}
+
+// The per-bit loop Lab 1 used before
+static const char *Bin2Asc(uint32_t binary)
+	{
+	static char bfr[9] ;
+	int32_t bit ;
+
+	for (bit = 7; bit >= 0; bit--)
+		{
+		bfr[7 - bit] = '0' + ((binary & (1 << bit)) != 0) ;
+		}
+	bfr[8] = '\0' ;
+
+	return bfr ;
+	}
+
+#endif
@@ -0,0 +1,27 @@
+/*
+	Bulk formatting of 8, 16 and 32-bit values as binary, grouped binary
+	and hexadecimal text into caller-provided buffers. Nothing is kept in
+	static storage, so the functions are reentrant.
+*/
+
+#ifndef FORMAT_H
+#define	FORMAT_H
+
+#include <stdint.h>
+
+// Characters needed per value (excluding any separator)
+#define	FMT_BIN_CHARS(bits)				(bits)
+#define	FMT_HEX_CHARS(bits)				((bits)/4)
+#define	FMT_GRP_CHARS(bits, group)		((bits) + (bits)/(group) - 1)
+
+// values points to an array of count uint8_t, uint16_t or uint32_t
+// (bits = 8, 16 or 32). Values are separated by sep unless sep is '\0'.
+// Each function NUL-terminates bfr and returns the number of characters
+// written, not counting the NUL.
+extern uint32_t	FormatBinary(char *bfr, const void *values, uint32_t count, uint32_t bits, char sep) ;
+extern uint32_t	FormatHex(char *bfr, const void *values, uint32_t count, uint32_t bits, char sep) ;
+
+// Binary with a space between each group of bits (group = 4, 8 or 16)
+extern uint32_t	FormatGrouped(char *bfr, const void *values, uint32_t count, uint32_t bits, uint32_t group, char sep) ;
+
+#endif
@@ -2,14 +2,17 @@
 #include <stdint.h>
 #include <stdarg.h>
 #include <string.h>
-#include <math.h>
 #include "library.h"
 #include "graphics.h"
+#include "counters.h"
+#include "format.h"
+#include "fixmath.h"
+#include "damage.h"
 
 // Functions to be implemented in a separate C file
 extern int32_t	Bits2Signed(int8_t bits[8]) ;
 extern uint32_t Bits2Unsigned(int8_t bits[8]) ;
-extern void		Increment(int8_t bits[8]) ;
+extern uint32_t	Increment(int8_t bits[8]) ;	// Returns INC_CARRY, INC_OVERFLOW
 extern void		Unsigned2Bits(uint32_t n, int8_t bits[8]) ;
 
 // Public fonts defined in run-time library
@@ -23,31 +26,27 @@ typedef struct
 extern sFONT	Font8, Font12, Font16, Font20, Font24 ;
 
 // Private functions defined in this file
-static float	AcuteRadians(float degrees) ;
-static char *	Bin2Asc(uint32_t binary) ;
 static uint8_t	Bits2Byte(int8_t bits[]) ;
 static void		Check(int8_t bits[], uint32_t ubinary, int32_t sbinary) ;
 static void		Error(int8_t bits[], uint32_t ubinary, int32_t sbinary, char *cause) ;
+static void		DamageTriangle(uint32_t x1, uint32_t x2, uint32_t x3, uint32_t y1, uint32_t y2, uint32_t y3) ;
 static void		Delay(uint32_t msec) ;
-static uint32_t	GetX(float deg, float percent, uint32_t radius) ;
+static uint32_t	GetX(ANGLE angle, uint32_t radius) ;
 static uint32_t GetTimeout(uint32_t msec) ;
-static uint32_t	GetY(float deg, float percent, uint32_t radius) ;
+static uint32_t	GetY(ANGLE angle, uint32_t radius) ;
 static void		InitializeDisplay(void) ;
 static void		LEDs(int grn_on, int red_on) ;
 static void		PutStringAt(uint32_t x, uint32_t y, char *format, ...) ;
 static void		SetFontSize(sFONT *pFont) ;
-static float	Sine(float radians) ;
-static float	SquareRoot(float radical) ;
 static void		UpdateCircle(uint32_t ubinary) ;
-static void		UpdateSigned(int32_t sbinary) ;
-static void		UpdateUnsigned(uint32_t ubinary) ;
+static void		UpdateSigned(int32_t sbinary, uint32_t overflow) ;
+static void		UpdateUnsigned(uint32_t ubinary, uint32_t carry) ;
 
 #define	ERR_FONT					Font12
 #define	ERR_BRDR_COLOR				COLOR_BLACK
 #define	ERR_BGND_COLOR				COLOR_RED
 #define	ERR_FGND_COLOR				COLOR_WHITE
 
-#define	PI							3.14159
 #define	CPU_CLOCK_SPEED_MHZ			168
 #define	ENTRIES(a)					(sizeof(a)/sizeof(a[0]))
 
@@ -146,19 +145,34 @@ static void		UpdateUnsigned(uint32_t ubinary) ;
 #define	OVFL_YOFF					35
 #define	OVFL_MSEC					500
 
+#define	PTR_HALF_ANGLE				ANGLE_DEG(7)
+
+#define	PIXELS_FONT					Font8
+#define	PIXELS_X					2
+#define	PIXELS_Y					(BINARY_Y + BINARY_FONT.Height + 4)
+
+#define	TICK_SIZE					10
+
+static DAMAGE						damage ;	// Regions changed in current frame
+
 int main(void)
 	{
-	uint32_t ubinary ;
+	uint32_t ubinary, flags ;
+	char text[FMT_BIN_CHARS(8) + 1] ;
 	int32_t sbinary ;
 	int8_t bits[8] ;
+	uint8_t byte ;
 
 	InitializeHardware(HEADER, "Lab 1: 8-bit Binary Numbers") ;
 	LEDs(1, 0) ;
 
 	InitializeDisplay() ;
 	Unsigned2Bits(0, bits) ;
+	flags = 0 ;
 	for (;;)
 		{
+		DamageReset(&damage) ;
+
 		ubinary = Bits2Unsigned(bits) ;
 		sbinary = Bits2Signed(bits) ;
 		Check(bits, ubinary, sbinary) ;
@@ -166,32 +180,42 @@ int main(void)
 		SetFontSize(&BINARY_FONT) ;
 		SetForeground(REP_COLOR) ;
 		SetBackground(COLOR_WHITE) ;
-		DisplayStringAt(BINARY_X, BINARY_Y, Bin2Asc(ubinary)) ;
+		byte = ubinary ;
+		FormatBinary(text, &byte, 1, 8, '\0') ;
+		DisplayStringAt(BINARY_X, BINARY_Y, text) ;
+		DamageAdd(&damage, BINARY_X, BINARY_Y, 8*BINARY_FONT.Width, BINARY_FONT.Height) ;
 
 		UpdateCircle(ubinary) ;
-		UpdateUnsigned(ubinary) ;
-		UpdateSigned(sbinary) ;
+		UpdateUnsigned(ubinary, flags & INC_CARRY) ;
+		UpdateSigned(sbinary, flags & INC_OVERFLOW) ;
+
+		SetFontSize(&PIXELS_FONT) ;
+		SetForeground(COLOR_BLACK) ;
+		SetBackground(COLOR_WHITE) ;	// A carry or overflow leaves it colored
+		PutStringAt(PIXELS_X, PIXELS_Y, "<=%5u pixels/frame", (unsigned) DamagePixels(&damage)) ;
 
 		Delay(30) ;
-		Increment(bits) ;
+		flags = Increment(bits) ;
 		}
 
 	return 0 ;
 	}
 
-static void UpdateUnsigned(uint32_t ubinary)
+static void UpdateUnsigned(uint32_t ubinary, uint32_t carry)
 	{
 	static uint32_t oldY = UBAR_Y + UBAR_SIZE/2 ;
 	static uint32_t timeout = 0 ;
+	static int32_t drawn = 0 ;
 	uint32_t k, newY ;
 	float percent ;
 
-	if (ubinary == 0)
+	if (carry)
 		{
 		SetFontSize(&OVFL_FONT) ;
 		SetForeground(COLOR_WHITE) ;
 		SetBackground(UNS_COLOR) ;
 		PutStringAt(OVFL_XPOS, CIRCLE_YPOS - OVFL_YOFF - OVFL_FONT.Height, OVFL_TEXT) ;
+		DamageAdd(&damage, OVFL_XPOS, CIRCLE_YPOS - OVFL_YOFF - OVFL_FONT.Height, strlen(OVFL_TEXT)*OVFL_FONT.Width, OVFL_FONT.Height) ;
 		timeout = GetTimeout(OVFL_MSEC) ;
 		}
 
@@ -201,38 +225,54 @@ static void UpdateUnsigned(uint32_t ubinary)
 		SetForeground(COLOR_WHITE) ;
 		SetBackground(COLOR_WHITE) ;
 		PutStringAt(OVFL_XPOS, CIRCLE_YPOS - OVFL_YOFF - OVFL_FONT.Height, OVFL_TEXT) ;
+		DamageAdd(&damage, OVFL_XPOS, CIRCLE_YPOS - OVFL_YOFF - OVFL_FONT.Height, strlen(OVFL_TEXT)*OVFL_FONT.Width, OVFL_FONT.Height) ;
 		timeout = 0 ;
 		}
 
 	percent = (float) ubinary / 256 ;
 	newY = 0.5 + (UBAR_Y + UBAR_SIZE - percent * UBAR_SIZE) ;
 
-	SetColor(COLOR_WHITE) ;
-	FillTriangle(U_X1, U_X2, U_X3, U_Y1(oldY), U_Y2(oldY), U_Y3(oldY)) ;
+	// Nothing to repaint if the pointer hasn't moved a pixel
+	if (drawn && newY == oldY) return ;
+
+	if (drawn)
+		{
+		DamageTriangle(U_X1, U_X2, U_X3, U_Y1(oldY), U_Y2(oldY), U_Y3(oldY)) ;
+		SetColor(COLOR_WHITE) ;
+		FillTriangle(U_X1, U_X2, U_X3, U_Y1(oldY), U_Y2(oldY), U_Y3(oldY)) ;
+		}
+	DamageTriangle(U_X1, U_X2, U_X3, U_Y1(newY), U_Y2(newY), U_Y3(newY)) ;
 	SetColor(UNS_COLOR) ;
 	FillTriangle(U_X1, U_X2, U_X3, U_Y1(newY), U_Y2(newY), U_Y3(newY)) ;
 	oldY = newY ;
+	drawn = 1 ;
 
+	// Repaint only the tick marks the pointer passed over
 	SetColor(UNS_COLOR) ;
 	for (k = 0; k < 5; k++)
 		{
-		DrawHLine(UBAR_X - 5, UBAR_Y + k*UBAR_SIZE/4, 10) ;
+		if (DamageTouches(&damage, UBAR_X - TICK_SIZE/2, UBAR_Y + k*UBAR_SIZE/4, TICK_SIZE, 1))
+			{
+			DrawHLine(UBAR_X - TICK_SIZE/2, UBAR_Y + k*UBAR_SIZE/4, TICK_SIZE) ;
+			}
 		}
 	}
 
-static void UpdateSigned(int32_t sbinary)
+static void UpdateSigned(int32_t sbinary, uint32_t overflow)
 	{
 	static uint32_t oldY = SBAR_Y + SBAR_SIZE/2 ;
 	static uint32_t timeout = 0 ;
+	static int32_t drawn = 0 ;
 	float percent ;
 	uint32_t k, newY ;
 
-	if (sbinary == -128)
+	if (overflow)
 		{
 		SetFontSize(&OVFL_FONT) ;
 		SetForeground(COLOR_WHITE) ;
 		SetBackground(SGN_COLOR) ;
 		PutStringAt(OVFL_XPOS, CIRCLE_YPOS + OVFL_YOFF, OVFL_TEXT) ;
+		DamageAdd(&damage, OVFL_XPOS, CIRCLE_YPOS + OVFL_YOFF, strlen(OVFL_TEXT)*OVFL_FONT.Width, OVFL_FONT.Height) ;
 		timeout = GetTimeout(OVFL_MSEC) ;
 		}
 
@@ -242,137 +282,106 @@ static void UpdateSigned(int32_t sbinary)
 		SetForeground(COLOR_WHITE) ;
 		SetBackground(COLOR_WHITE) ;
 		PutStringAt(OVFL_XPOS, CIRCLE_YPOS + OVFL_YOFF, OVFL_TEXT) ;
+		DamageAdd(&damage, OVFL_XPOS, CIRCLE_YPOS + OVFL_YOFF, strlen(OVFL_TEXT)*OVFL_FONT.Width, OVFL_FONT.Height) ;
 		timeout = 0 ;
 		}
 
 	percent = (float) sbinary / 128 ;
 	newY = 0.5 + (SBAR_Y + SBAR_SIZE/2 - percent * SBAR_SIZE/2) ;
 
-	SetColor(COLOR_WHITE) ;
-	FillTriangle(S_X1, S_X2, S_X3, S_Y1(oldY), S_Y2(oldY), S_Y3(oldY)) ;
+	// Nothing to repaint if the pointer hasn't moved a pixel
+	if (drawn && newY == oldY) return ;
+
+	if (drawn)
+		{
+		DamageTriangle(S_X1, S_X2, S_X3, S_Y1(oldY), S_Y2(oldY), S_Y3(oldY)) ;
+		SetColor(COLOR_WHITE) ;
+		FillTriangle(S_X1, S_X2, S_X3, S_Y1(oldY), S_Y2(oldY), S_Y3(oldY)) ;
+		}
+	DamageTriangle(S_X1, S_X2, S_X3, S_Y1(newY), S_Y2(newY), S_Y3(newY)) ;
 	SetColor(SGN_COLOR) ;
 	FillTriangle(S_X1, S_X2, S_X3, S_Y1(newY), S_Y2(newY), S_Y3(newY)) ;
 	oldY = newY ;
+	drawn = 1 ;
 
+	// Repaint only the tick marks the pointer passed over
 	SetColor(SGN_COLOR) ;
 	for (k = 0; k < 5; k++)
 		{
-		DrawHLine(SBAR_X - 5, SBAR_Y + k*SBAR_SIZE/4, 10) ;
-		}
-	}
-
-static char *Bin2Asc(uint32_t binary)
-	{
-	static char bfr[9] ;
-	int32_t bit ;
-
-	for (bit = 7; bit >= 0; bit--)
-		{
-		bfr[7 - bit] = '0' + ((binary & (1 << bit)) != 0) ;
+		if (DamageTouches(&damage, SBAR_X - TICK_SIZE/2, SBAR_Y + k*SBAR_SIZE/4, TICK_SIZE, 1))
+			{
+			DrawHLine(SBAR_X - TICK_SIZE/2, SBAR_Y + k*SBAR_SIZE/4, TICK_SIZE) ;
+			}
 		}
-	bfr[8] = '\0' ;
-
-	return bfr ;
-	}
-
-static float AcuteRadians(float degrees)
-	{
-	float acute ;
-
-	if      (degrees > 270)	acute = 360 - degrees ;
-	else if (degrees > 180)	acute = degrees - 180 ;
-	else if (degrees >  90)	acute = 180 - degrees ;
-	else					acute = degrees ;
-
-	return 	(PI * acute) / 180 ;
 	}
 
-static uint32_t GetX(float deg, float percent, uint32_t radius)
+static uint32_t GetX(ANGLE angle, uint32_t radius)
 	{
-	if      (deg > 270)	return 0.5 + CIRCLE_XPOS - percent * radius ;
-	else if (deg > 180)	return 0.5 + CIRCLE_XPOS - percent * radius ;
-	else if (deg >  90)	return 0.5 + CIRCLE_XPOS + percent * radius ;
-	else				return 0.5 + CIRCLE_XPOS + percent * radius ;
+	// Round Q15 product to nearest pixel
+	return CIRCLE_XPOS + ((SinQ15(angle) * (int32_t) radius + Q15_ONE/2) >> 15) ;
 	}
 
-static uint32_t GetY(float deg, float percent, uint32_t radius)
+static uint32_t GetY(ANGLE angle, uint32_t radius)
 	{
-	if      (deg > 270)	return 0.5 + CIRCLE_YPOS - percent * radius ;
-	else if (deg > 180)	return 0.5 + CIRCLE_YPOS + percent * radius ;
-	else if (deg >  90)	return 0.5 + CIRCLE_YPOS + percent * radius ;
-	else				return 0.5 + CIRCLE_YPOS - percent * radius ;
+	// Screen y grows downward, so 0 degrees is straight up
+	return CIRCLE_YPOS - ((CosQ15(angle) * (int32_t) radius + Q15_ONE/2) >> 15) ;
 	}
 
 static void UpdateCircle(uint32_t binary)
 	{
-	float sin1, sin2, sin3, cos1, cos2, cos3 ;
 	static uint32_t x1, x2, x3, y1, y2, y3 ;
 	static int32_t erase = 0 ; 
-	float deg1, deg2, deg3 ;
+	uint32_t nx1, nx2, nx3, ny1, ny2, ny3 ;
+	ANGLE angle ;
+
+	// 256 counts per revolution: one count is 1/256 of 0x10000
+	angle = binary << 8 ;
+
+	nx1 = GetX(angle - PTR_HALF_ANGLE, CIRCLE_INNER_RAD) ;
+	nx2 = GetX(angle,                  CIRCLE_OUTER_RAD) ;
+	nx3 = GetX(angle + PTR_HALF_ANGLE, CIRCLE_INNER_RAD) ;
+
+	ny1 = GetY(angle - PTR_HALF_ANGLE, CIRCLE_INNER_RAD) ;
+	ny2 = GetY(angle,                  CIRCLE_OUTER_RAD) ;
+	ny3 = GetY(angle + PTR_HALF_ANGLE, CIRCLE_INNER_RAD) ;
+
+	// Nothing to repaint if no vertex has moved a pixel
+	if (erase && nx1 == x1 && nx2 == x2 && nx3 == x3 && ny1 == y1 && ny2 == y2 && ny3 == y3) return ;
 
 	if (erase)
 		{
+		DamageTriangle(x1, x2, x3, y1, y2, y3) ;
 		SetColor(COLOR_WHITE) ;
 		FillTriangle(x1, x2, x3, y1, y2, y3) ;
 		}
 	erase = 1 ;
 
-	deg1 = (binary * 360) / 256.0 - 7.0 ;
-	deg2 = (binary * 360) / 256.0 + 0.0 ;
-	deg3 = (binary * 360) / 256.0 + 7.0 ;
-
-	if (deg1 <    0) deg1 += 360 ;
-	if (deg3 >= 360) deg3 -= 360 ;
-
-	sin1 = Sine(AcuteRadians(deg1)) ;
-	sin2 = Sine(AcuteRadians(deg2)) ;
-	sin3 = Sine(AcuteRadians(deg3)) ;
-
-	cos1 = SquareRoot(1.0 - sin1*sin1) ;
-	cos2 = SquareRoot(1.0 - sin2*sin2) ;
-	cos3 = SquareRoot(1.0 - sin3*sin3) ;
-
-	x1 = GetX(deg1, sin1, CIRCLE_INNER_RAD) ;
-	x2 = GetX(deg2, sin2, CIRCLE_OUTER_RAD) ;
-	x3 = GetX(deg3, sin3, CIRCLE_INNER_RAD) ;
-
-	y1 = GetY(deg1, cos1, CIRCLE_INNER_RAD) ;
-	y2 = GetY(deg2, cos2, CIRCLE_OUTER_RAD) ;
-	y3 = GetY(deg3, cos3, CIRCLE_INNER_RAD) ;
-
+	x1 = nx1 ; x2 = nx2 ; x3 = nx3 ;
+	y1 = ny1 ; y2 = ny2 ; y3 = ny3 ;
+	DamageTriangle(x1, x2, x3, y1, y2, y3) ;
 	SetColor(REP_COLOR) ;
 	FillTriangle(x1, x2, x3, y1, y2, y3) ;
 
+	// Repaint only the tick marks the pointer passed over
 	SetColor(COLOR_BLACK) ;
-	DrawVLine(CIRCLE_XPOS, CIRCLE_YPOS - CIRCLE_OUTER_RAD - 5, 10) ;
-	DrawHLine(CIRCLE_XPOS + CIRCLE_OUTER_RAD - 5, CIRCLE_YPOS, 10) ;
-	DrawVLine(CIRCLE_XPOS, CIRCLE_YPOS + CIRCLE_OUTER_RAD - 5, 10) ;
-	DrawHLine(CIRCLE_XPOS - CIRCLE_OUTER_RAD - 5, CIRCLE_YPOS, 10) ;
+	if (DamageTouches(&damage, CIRCLE_XPOS, CIRCLE_YPOS - CIRCLE_OUTER_RAD - TICK_SIZE/2, 1, TICK_SIZE))
+		DrawVLine(CIRCLE_XPOS, CIRCLE_YPOS - CIRCLE_OUTER_RAD - TICK_SIZE/2, TICK_SIZE) ;
+	if (DamageTouches(&damage, CIRCLE_XPOS + CIRCLE_OUTER_RAD - TICK_SIZE/2, CIRCLE_YPOS, TICK_SIZE, 1))
+		DrawHLine(CIRCLE_XPOS + CIRCLE_OUTER_RAD - TICK_SIZE/2, CIRCLE_YPOS, TICK_SIZE) ;
+	if (DamageTouches(&damage, CIRCLE_XPOS, CIRCLE_YPOS + CIRCLE_OUTER_RAD - TICK_SIZE/2, 1, TICK_SIZE))
+		DrawVLine(CIRCLE_XPOS, CIRCLE_YPOS + CIRCLE_OUTER_RAD - TICK_SIZE/2, TICK_SIZE) ;
+	if (DamageTouches(&damage, CIRCLE_XPOS - CIRCLE_OUTER_RAD - TICK_SIZE/2, CIRCLE_YPOS, TICK_SIZE, 1))
+		DrawHLine(CIRCLE_XPOS - CIRCLE_OUTER_RAD - TICK_SIZE/2, CIRCLE_YPOS, TICK_SIZE) ;
 	}
 
-static float Sine(float radians)
+static void DamageTriangle(uint32_t x1, uint32_t x2, uint32_t x3, uint32_t y1, uint32_t y2, uint32_t y3)
 	{
-	static float coef[] =
-		{
-		 0.0,					//  0/0!
-		+1.0/(1),				// +1/1!
-		 0.0,					//  0/2!
-		-1.0/(3*2*1),			// -1/3!
-		 0.0,					//  0/4!
-		+1.0/(5*4*3*2*1),		// +1/5!
-		 0.0,					//  0/6!
-		-1.0/(7*6*5*4*3*2*1)	// -1/7!
-		} ;
-	float poly, *p ;
-	uint32_t k ;
-
-	poly = 0.0 ;
-	p = &coef[ENTRIES(coef)] ;
-	for (k = 0; k < ENTRIES(coef); k++)
-		{
-		poly = poly * radians + *--p ;
-		}
-	return poly ;
+#	define	MIN3(a,b,c)	((a) < (b) ? ((a) < (c) ? (a) : (c)) : ((b) < (c) ? (b) : (c)))
+#	define	MAX3(a,b,c)	((a) > (b) ? ((a) > (c) ? (a) : (c)) : ((b) > (c) ? (b) : (c)))
+	uint32_t xmin = MIN3(x1, x2, x3) ;
+	uint32_t ymin = MIN3(y1, y2, y3) ;
+
+	DamageAdd(&damage, xmin, ymin, MAX3(x1, x2, x3) - xmin + 1, MAX3(y1, y2, y3) - ymin + 1) ;
 	}
 
 static void InitializeDisplay(void)
@@ -405,23 +414,6 @@ static void InitializeDisplay(void)
 	PutStringAt(REP34TH_X, REP34TH_Y, REP34TH_TXT) ;
 	}
 
-static float SquareRoot(float radical)
-	{
-	float sqrt, error ;
-	uint32_t k ;
-
-	if (radical == 0.0) return 0.0 ;
-	sqrt = 1.0 ;
-	for (k = 0; k < 100; k++)
-		{
-		error = fabs(sqrt*sqrt - radical) ;
-		if (error <= 0.00001) break ;
-		sqrt = (radical / sqrt + sqrt) / 2.0 ;
-    	}
-
-	return sqrt ;
-	}
-
 static uint32_t GetTimeout(uint32_t msec)
 	{
 	uint32_t cycles = 1000 * msec * CPU_CLOCK_SPEED_MHZ ;
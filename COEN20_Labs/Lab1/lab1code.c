@@ -1,109 +1,113 @@
 #include <stdint.h>
-#include <math.h>
+#include "bitpack.h"
+#include "bitcodec.h"
+#include "counters.h"
+
+BITCODEC(8)
 
 
 uint32_t Bits2Unsigned(int8_t bits[8]){
-	int i;
-	int n;
-	int ans=0;
-	for(i=7;i>=0;i--)//for loop that converts bits into unsigned number
-	{
-	  n=pow(2,i)*bits[i];
-	  ans=ans+n;
-	}
-return ans;
+	uint8_t byte;
+	PackBits(&byte,bits,1);//gathers the 8 bits into one byte, no floating point
+return byte;
 }
 
 int32_t Bits2Signed(int8_t bits[8]){
-	int32_t output=(int32_t)Bits2Unsigned(bits);//calls unsigned function above
-	if(output>127)
-	{
-	output=output-256;
-	}
-	return output;
-//	int ovf=0;
-//	int i;
-//	for(i=7;i>=0;i--)
-//	{
-//	  if(bits[i]==1)
-//	  	bits[i]=0;
-//	  else
-//		bits[i]=1;
-//	}
-//
-//	if(bits[0]==0)
-//		bits[0]=1;
-//	else
-//	{
-//		bits[0]=0;
-//		ovf=1;
-//	}
-//
-//	for(i=1;i<=7;i++)
-//	{
-//	  if(bits[i]==0)
-//		bits[i]=0+ovf;
-//	  else
-//		if(ovf==1)
-//		  { 
-//			bits[i]=0;
-//			ovf=1;
-//		  }
-//	}
-//	
-//	int n;
-//	int ans=0;
-//	for(i=7;i>=0;i--)
-//	{
-//	  n=pow(2,i)*bits[i];
-//	  ans=ans+n;
-//	}
-
-//return ans;
+	return Bits2Signed8(bits);//sign extends bit 7, no hard-coded 127/256
 }
 
 
 
-void Increment(int8_t bits[8]){
-//	int ovf=0;
-	int i;
+uint32_t Increment(int8_t bits[8]){
+	return IncrementBits8(bits);//constant time, returns INC_CARRY/INC_OVERFLOW
+}
 
-//	if(bits[0]==0)
-//		{bits[0]=1;
-//		return;}
-//	else
-//	{
-//		bits[0]=0;
-//		ovf=1;
-//	}
+void Unsigned2Bits(uint32_t n, int8_t bits[8]){
+	uint8_t byte=n;
+	UnpackBits(bits,&byte,1);//spreads the byte out into 8 bits by table lookup
 
-	for(i=0;i<=7;i++)
-	{
-	  if(bits[i]==0)//if the bits are 0 it becomes 1 and you can return the function since the overflow wont come
-		{bits[i]=1;
-		return;}
-	  else
-		bits[i]=0;
-//		if(ovf==1)
-//		  { 
-//			bits[i]=0;
-//			ovf=1;
-//		  } 
+}
+#ifdef BITCODEC_TEST
+
+#include <stdio.h>
+#include <string.h>
+#include "harness.h"
+
+#define	TRIALS			200000	// Per width above 16 bits
+
+// Checks every function of BITCODEC(W): every value if W <= 16, else
+// TRIALS random values plus the edges. A guard byte past bits[W-1]
+// must never be written.
+#define	CHECK_WIDTH(W)																	\
+BITCODEC(W)																				\
+static int Check##W(void)																\
+	{																					\
+	const uint64_t mask = ~0ULL >> (64 - (W)), sign = BITCODEC_SIGN(W) ;				\
+	static const uint64_t edges[] = {0, 1, ~0ULL, ~0ULL >> 1, 1ULL << 63} ;				\
+	uint64_t n, trial, trials ;															\
+	int8_t bits[(W) + 1] ;																\
+	int64_t signd ;																		\
+	uint32_t carry ;																	\
+	int errors = 0, k ;																	\
+																						\
+	trials = ((W) <= 16) ? mask + 1 : TRIALS + 5 ;										\
+	for (trial = 0; trial < trials; trial++)											\
+		{																				\
+		if ((W) <= 16) n = trial ;														\
+		else n = ((trial < 5) ? edges[trial] : HarnessRandom64()) & mask ;						\
+		signd = (n & sign) ? -(int64_t) (~n & mask) - 1 : (int64_t) n ;					\
+																						\
+		bits[W] = 0x55 ;																\
+		Unsigned2Bits##W(n, bits) ;														\
+		for (k = 0; k < (W); k++) if (bits[k] != (int8_t) ((n >> k) & 1)) break ;		\
+		if (k != (W)) errors++ ;														\
+		if (Bits2Unsigned##W(bits) != n) errors++ ;										\
+		if (Bits2Signed##W(bits) != signd) errors++ ;									\
+		carry = Increment##W(bits) ;													\
+		if (Bits2Unsigned##W(bits) != ((n + 1) & mask)) errors++ ;						\
+		if (carry != (n == mask)) errors++ ;											\
+		if (bits[W] != 0x55) errors++ ;													\
+		}																				\
+	if (errors != 0) printf("width %d: %d errors\n", (W), errors) ;						\
+	return errors ;																		\
 	}
 
-}
+CHECK_WIDTH(1)	CHECK_WIDTH(2)	CHECK_WIDTH(3)	CHECK_WIDTH(4)
+CHECK_WIDTH(5)	CHECK_WIDTH(6)	CHECK_WIDTH(7)	CHECK_WIDTH(9)
+CHECK_WIDTH(10)	CHECK_WIDTH(11)	CHECK_WIDTH(12)	CHECK_WIDTH(13)
+CHECK_WIDTH(14)	CHECK_WIDTH(15)	CHECK_WIDTH(16)	CHECK_WIDTH(17)
+CHECK_WIDTH(24)	CHECK_WIDTH(31)	CHECK_WIDTH(32)	CHECK_WIDTH(33)
+CHECK_WIDTH(48)	CHECK_WIDTH(63)	CHECK_WIDTH(64)
 
-void Unsigned2Bits(uint32_t n, int8_t bits[8]){
-	int i=0;
-	for(i=7;i>=0;i--)
+// Width 8 is already instantiated above for Lab 1
+static int Check8(void)
 	{
-	  if(pow(2,i)>n)//find largest power of 2 which is less than the n
-	   bits[i]=0;
-	  else
-          {
-	    bits[i]=1;
-	    n=n-(pow(2,i));//decrement n by the largest power of n
-	  }
+	int8_t bits[8], again[8] ;
+	uint32_t n ;
+	int errors = 0 ;
+
+	for (n = 0; n < 256; n++)
+		{
+		Unsigned2Bits8(n, bits) ;
+		Unsigned2Bits(n, again) ;
+		if (memcmp(bits, again, 8) != 0) errors++ ;
+		if (Bits2Unsigned8(bits) != n || Bits2Unsigned(bits) != n) errors++ ;
+		if (Bits2Signed8(bits) != (int8_t) n || Bits2Signed(bits) != (int8_t) n) errors++ ;
+		if (Increment8(bits) != (n == 255) || Bits2Unsigned8(bits) != ((n + 1) & 0xFF)) errors++ ;
+		}
+	if (errors != 0) printf("width 8: %d errors\n", errors) ;
+	return errors ;
+	}
+
+int main(void)
+	{
+	int errors ;
+
+	errors  = Check1() + Check2() + Check3() + Check4() + Check5() + Check6() + Check7() + Check8() ;
+	errors += Check9() + Check10() + Check11() + Check12() + Check13() + Check14() + Check15() + Check16() ;
+	errors += Check17() + Check24() + Check31() + Check32() + Check33() + Check48() + Check63() + Check64() ;
+	printf("widths 1-16 exhaustive, 17-64 random: %d errors\n", errors) ;
+	return errors != 0 ;
 	}
 
-}
\ No newline at end of file
+#endif
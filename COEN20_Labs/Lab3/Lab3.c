@@ -12,6 +12,11 @@
 #include <string.h>
 #include "library.h"
 #include "graphics.h"
+#include "copy.h"
+#include "dma.h"
+#include "bench.h"
+#include "dispatch.h"
+#include "fill.h"
 
 extern void				UseLDRB(void *dst, void *src) ;
 extern void				UseLDRH(void *dst, void *src) ;
@@ -45,12 +50,23 @@ typedef struct
 	unsigned			cycles ;
 	} RESULT ;
 
+// Public fonts defined in run-time library
+typedef struct
+	{
+	const uint8_t *		table ;
+	const uint16_t		Width ;
+	const uint16_t		Height ;
+	} sFONT ;
+
+extern sFONT Font8, Font12, Font16, Font20, Font24 ;
+
 static int				Check(uint8_t *src, uint8_t *dst) ;
 static int				Compare(const void *p1, const void *p2) ;
 static void				Delay(uint32_t msec) ;
 static void				FillSpectrum(int x, int y, int height) ;
 static uint32_t 		GetTimeout(uint32_t msec) ;
 static void				LEDs(int grn_on, int red_on) ;
+static void				SetFontSize(sFONT *Font) ;
 static void				Setup(uint8_t *src, uint8_t *dst) ;
 static void				ShowBest(RESULT results[]) ;
 static void				ShowResult(int which, RESULT results[], unsigned maxCycles) ;
@@ -58,9 +74,9 @@ static unsigned			UseDMA(void) ;
 static RGB				HSV2RGB(HSV *hsv) ;
 
 #define	BAR_OFFSET			70
-#define	BAR_WIDTH			30
+#define	BAR_WIDTH			22
 #define	MAX_HEIGHT			210
-#define	FUNCTIONS			7
+#define	FUNCTIONS			9
 #define CPU_CLOCK_SPEED_MHZ 168
 
 #define	MIN(a,b)	((a < b) ? a : b)
@@ -68,6 +84,7 @@ static RGB				HSV2RGB(HSV *hsv) ;
 
 #define FONT_WIDTH		7
 #define FONT_HEIGHT		12
+#define	BAR_FONT		Font8	// 5 pixels wide, so 5 digits fit a bar's 26-pixel slot
 
 static uint8_t src[512] __attribute__ ((aligned (1024))) ; // DMA burst mode cannot cross 1KB boiundary
 static uint8_t dst[512] __attribute__ ((aligned (1024))) ; // DMA burst mode cannot cross 1KB boiundary
@@ -81,6 +98,8 @@ int main(void)
 		{"LDR",		UseLDR},
 		{"LDRD",	UseLDRD},
 		{"LDM",		UseLDM},
+		{"Copy",	CopyBlock},
+		{"Auto",	CopyAuto},
 		{"mcpy",	(void (*)()) memcpy},
 		{"DMA",		NULL}
 		} ;
@@ -98,6 +117,7 @@ int main(void)
 	if (srcErr || dstErr) while (1) ;
 
 	LEDs(1, 0) ;
+	DispatchCalibrate(copyStrategies, copyStrategyCount, 5) ;
 	ovhd = CountCycles(CallReturnOverhead, dummy, dummy, dummy) ;
 	for (which = 0; which < FUNCTIONS - 1; which++)
 		{
@@ -120,29 +140,38 @@ int main(void)
 		}
 	ShowBest(results) ;
 
+#ifdef BENCH_SWEEP
+	// Size/alignment sweep of every strategy, as CSV on stdout
+	static const SWEEP sweep = {4, BENCH_MAX_BYTES, 4, 9, BENCH_CSV} ;
+	BenchSweep(&sweep, copyStrategies, copyStrategyCount) ;
+	BenchSweep(&sweep, fillStrategies, fillStrategyCount) ;
+	BenchSweep(&sweep, checksumStrategies, checksumStrategyCount) ;
+#endif
+
+#ifdef COPY_TEST
+	// Every length up to 4 KB at every src/dst alignment, against memcmp
+	for (which = 0; which < (int) copyStrategyCount; which++)
+		{
+		printf("%-6s %u wrong copies\n", copyStrategies[which].label, (unsigned) BenchCheck(&copyStrategies[which], 4096)) ;
+		}
+#endif
+
 	return 0 ;
 	}
 
 static void Setup(uint8_t *src, uint8_t *dst)
 	{
+	uint32_t *words = (uint32_t *) src ;
 	int k ;
 
-	for (k = 0; k < 512; k++)
-		{
-		*src++ = rand() ;
-		*dst++ = rand() ;
-		}
+	// rand() gives 31 bits, so one call would leave bit 31 clear
+	for (k = 0; k < 512/4; k++) *words++ = ((uint32_t) rand() << 16) ^ (uint32_t) rand() ;
+	FillPattern(dst, ~*(uint32_t *) src, 512) ;	// Differs from src in every byte of the first word
 	}
 
 static int Check(uint8_t *src, uint8_t *dst)
 	{
-	int k ;
-
-	for (k = 0; k < 512; k++)
-		{
-		if (*src++ != *dst++) return k ;
-		}
-	return -1 ;
+	return CompareBlock(src, dst, 512) ;
 	}
 
 static void ShowResult(int which, RESULT results[], unsigned maxCycles)
@@ -154,7 +183,9 @@ static void ShowResult(int which, RESULT results[], unsigned maxCycles)
 	x = (XPIXELS / FUNCTIONS)*which + XPIXELS / (2*FUNCTIONS) - BAR_WIDTH / 2 ;
 	y = MAX_HEIGHT*(1 - percent) + BAR_OFFSET ;
 
-	offset = (BAR_WIDTH - FONT_WIDTH*strlen(results[which].label)) / 2 ;
+	// In int: strlen is unsigned, and a label wider than the bar must not wrap
+	SetFontSize(&BAR_FONT) ;
+	offset = MAX((BAR_WIDTH - BAR_FONT.Width*(int) strlen(results[which].label)) / 2, 0) ;
 	DisplayStringAt(x + offset, BAR_OFFSET + MAX_HEIGHT + 5, results[which].label) ;
 	if (results[which].index >= 0)
 		{
@@ -166,8 +197,9 @@ static void ShowResult(int which, RESULT results[], unsigned maxCycles)
 	else FillSpectrum(x, y, (unsigned) (percent*MAX_HEIGHT)) ;
 
 	sprintf(text, "%u", results[which].cycles) ;
-	offset = (BAR_WIDTH - FONT_WIDTH*strlen(text)) / 2 ;
-	DisplayStringAt(x + offset, y - 13, text) ;
+	offset = MAX((BAR_WIDTH - BAR_FONT.Width*(int) strlen(text)) / 2, 0) ;
+	DisplayStringAt(x + offset, y - BAR_FONT.Height - 1, text) ;
+	SetFontSize(&Font12) ;
 
 	if (results[which].index < 0) return ;
 
@@ -211,43 +243,13 @@ static void FillSpectrum(int x, int ymin, int height)
 
 static unsigned UseDMA(void)
 	{
-	static		uint32_t	const MBURST		= (1 << 23) ;	// Write burst of 4 beats
-	static		uint32_t	const PBURST		= (1 << 21) ;	// Read burst of 4 beats
-	static		uint32_t	const MSIZE			= (2 << 13) ;	// Write 32-bit words
-	static		uint32_t	const PSIZE			= (2 << 11) ;	// Read 32-bit words
-	static		uint32_t	const MINC			= (1 << 10) ;	// Autoincr dst adrs
-	static		uint32_t	const PINC			= (1 <<  9) ;	// Autoincr src adrs
-	static		uint32_t	const DIR			= (2 <<  6) ;	// Memory-To-Memory
-	static		uint32_t	const EN			= (1 <<  0) ;	// "Go"
-	static		uint32_t	const FTH			= (3 <<  0) ;	// FIFO threshold = full
-	static		uint32_t	const DMDIS			= (1 <<  2) ;	// Direct mode disabled
-	static		uint32_t	const TCIF0			= (1 <<  5) ;	// Transfer complete flag
-	volatile	uint32_t *	const pDMA2_LISR	= (uint32_t *) 0x40026400 ;
-	static		uint32_t *	const pDMA2_LIFCR	= (uint32_t *) 0x40026408 ;
-	static		uint32_t *	const pDMA2_S0CR	= (uint32_t *) 0x40026410 ;
-	static		uint32_t *	const pDMA2_S0NDTR	= (uint32_t *) 0x40026414 ;
-	static		void **		const pDMA2_S0PAR	= (void **)    0x40026418 ;
-	static		void **		const pDMA2_S0M0AR	= (void **)    0x4002641C ;
-	static		uint32_t *	const pDMA2_S0FCR	= (uint32_t *) 0x40026424 ;
-	static		uint32_t *	const pRCC_AHB1ENR	= (uint32_t *) 0x40023830 ;
-
 	uint32_t strt, stop, zero ;
 
-	*pRCC_AHB1ENR |= (1 << 22) ; 			// Enable DMA Clock
-
-	*pDMA2_S0CR     = 0 ; 					// Disable DMA
-	*pDMA2_S0PAR    = src ; 				// Setup src address
-	*pDMA2_S0M0AR   = dst ; 				// Setup dst address
-	*pDMA2_S0NDTR   = 512/4 ; 				// Setup word count
-	*pDMA2_S0FCR	= DMDIS|FTH ;			// Setup FIFO
-
+	// Only the transfer is timed, not setting up the stream
+	DMA_Prepare(dst, src, 512) ;
 	zero = GetClockCycleCount() ;
-	*pDMA2_LIFCR	= TCIF0 ;				// Clear TCIF0
-	while ((*pDMA2_LISR & TCIF0) != 0) ;	// wait for TCIF0 = 0
-
 	strt = GetClockCycleCount() ;
-	*pDMA2_S0CR = MBURST|PBURST|MSIZE|PSIZE|MINC|PINC|DIR|EN ;
-	while ((*pDMA2_LISR & TCIF0) == 0) ;	// wait for TCIF0 = 1
+	DMA_Run() ;
 	stop = GetClockCycleCount() ;
 
 	return (stop - strt) - (strt - zero) ;
@@ -343,4 +345,8 @@ static void ShowBest(RESULT results[])
 	DisplayStringAt(x + FONT_WIDTH/2, RESULT_Y + (3*FONT_HEIGHT/2), rate) ;
 	}
 
-
+static void SetFontSize(sFONT *Font)
+	{
+	extern void BSP_LCD_SetFont(sFONT *) ;
+	BSP_LCD_SetFont(Font) ;
+	}
@@ -0,0 +1,386 @@
+/*
+	Copy benchmark sweep.
+
+	Every strategy is run reps times per (size, src offset, dst offset)
+	configuration it supports; the fastest, median and slowest times are
+	reported, less the cost of reading the timer. Each configuration is
+	checked once against the source so a fast but broken copy stands out.
+	BenchMin runs a single configuration for the copy dispatcher.
+
+	Fill and compare kernels run through the same harness by way of
+	adapters with the copy signature: fills store BENCH_FILL_BYTE into
+	dst, compares are handed identical buffers so they run to the end.
+	Fused copy-and-checksum is paired with memcpy followed by the plain
+	checksum so the two can be compared directly; both must return what
+	the plain C checksum gives for src as well as copying it.
+
+	BenchCheck is the exhaustive correctness test: every length up to a
+	limit at every src and dst offset from 0 to 3, with guard bytes on
+	both sides of dst that must come through untouched.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "bench.h"
+#include "checksum.h"
+
+#ifdef __arm__
+#include "library.h"
+#include "copy.h"
+#include "dma.h"
+#include "fill.h"
+#else
+#include "harness.h"
+#endif
+
+#define	GUARD			4			// Bytes either side of dst in BenchCheck
+#define	GUARD_BYTE		0x5A
+
+typedef struct
+	{
+	uint32_t			min ;
+	uint32_t			median ;
+	uint32_t			max ;
+	} STATS ;
+
+static void				ByteLoop(void *dst, const void *src, uint32_t bytes) ;
+static int				ChecksumOK(const uint8_t *s, uint32_t bytes) ;
+static void				Memcmp(void *dst, const void *src, uint32_t bytes) ;
+static int				Measure(const STRATEGY *s, uint32_t bytes, uint32_t soff, uint32_t doff, uint32_t times[], uint32_t reps) ;
+static void				Memcpy(void *dst, const void *src, uint32_t bytes) ;
+static void				Memset(void *dst, const void *src, uint32_t bytes) ;
+static void				Prepare(void) ;
+static void				Report(const SWEEP *sweep, const char *label, uint32_t bytes, uint32_t soff, uint32_t doff, STATS *stats, int ok) ;
+static void				Sort(uint32_t times[], uint32_t count) ;
+static uint32_t			Ticks(void) ;
+
+static uint8_t			src[BENCH_MAX_BYTES + 16] __attribute__ ((aligned (1024))) ;
+static uint8_t			dst[BENCH_MAX_BYTES + 16] __attribute__ ((aligned (1024))) ;
+static int				first ;
+static uint32_t			ovhd ;		// Cost of reading the timer twice
+static volatile uint32_t checked ;	// Result of the last checksum adapter
+static uint32_t			(*reference)(const void *src, uint32_t bytes) ;	// What checked should be
+static int32_t			compared ;	// Result of the last compare adapter
+
+const STRATEGY			copyStrategies[] =
+	{
+#ifdef __arm__
+	{"LDRB",	CopyLDRB,	1,	1,	BENCH_COPY},
+	{"LDRH",	CopyLDRH,	2,	1,	BENCH_COPY},
+	{"LDR",		CopyLDR,	4,	1,	BENCH_COPY},
+	{"LDRD",	CopyLDRD,	4,	1,	BENCH_COPY},
+	{"LDM",		CopyLDM,	4,	1,	BENCH_COPY},
+	{"Copy",	CopyBlock,	1,	1,	BENCH_COPY},
+	{"DMA",		DMA_Copy,	1,	4,	BENCH_COPY},
+#endif
+	{"bytes",	ByteLoop,	1,	1,	BENCH_COPY},
+	{"mcpy",	Memcpy,		1,	1,	BENCH_COPY}
+	} ;
+const uint32_t			copyStrategyCount = sizeof(copyStrategies)/sizeof(copyStrategies[0]) ;
+
+#ifdef __arm__
+static void				Compare(void *dst, const void *src, uint32_t bytes) ;
+static void				Fill(void *dst, const void *src, uint32_t bytes) ;
+static void				Pattern(void *dst, const void *src, uint32_t bytes) ;
+#endif
+
+const STRATEGY			fillStrategies[] =
+	{
+#ifdef __arm__
+	{"fill",	Fill,		1,	1,	BENCH_FILL},
+	{"pat",		Pattern,	1,	1,	BENCH_FILL},
+	{"cmp",		Compare,	1,	1,	BENCH_COMPARE},
+#endif
+	{"mset",	Memset,		1,	1,	BENCH_FILL},
+	{"mcmp",	Memcmp,		1,	1,	BENCH_COMPARE}
+	} ;
+const uint32_t			fillStrategyCount = sizeof(fillStrategies)/sizeof(fillStrategies[0]) ;
+
+#define	CHECKSUM_ADAPTERS(name, fused, plain)							\
+static void name##Fused(void *dst, const void *src, uint32_t bytes)		\
+	{																	\
+	checked = fused(dst, src, bytes) ;									\
+	reference = plain ;													\
+	}																	\
+static void name##Split(void *dst, const void *src, uint32_t bytes)		\
+	{																	\
+	memcpy(dst, src, bytes) ;											\
+	checked = plain(dst, bytes) ;										\
+	reference = plain ;													\
+	}
+
+CHECKSUM_ADAPTERS(Sum, CopySum32, Sum32)
+CHECKSUM_ADAPTERS(Fletcher, CopyFletcher32, Fletcher32)
+CHECKSUM_ADAPTERS(Crc, CopyCrc32, Crc32)
+
+const STRATEGY			checksumStrategies[] =
+	{
+	{"+sum",	SumFused,		1,	4,	BENCH_COPY},
+	{"sum",		SumSplit,		1,	4,	BENCH_COPY},
+	{"+fl32",	FletcherFused,	1,	4,	BENCH_COPY},
+	{"fl32",	FletcherSplit,	1,	4,	BENCH_COPY},
+	{"+crc",	CrcFused,		1,	4,	BENCH_COPY},
+	{"crc",		CrcSplit,		1,	4,	BENCH_COPY}
+	} ;
+const uint32_t			checksumStrategyCount = sizeof(checksumStrategies)/sizeof(checksumStrategies[0]) ;
+
+void BenchSweep(const SWEEP *sweep, const STRATEGY strategies[], uint32_t count)
+	{
+	uint32_t times[BENCH_MAX_REPS], bytes, soff, doff, reps ;
+	const STRATEGY *s ;
+	STATS stats ;
+	int ok ;
+
+	reps = (sweep->reps > BENCH_MAX_REPS) ? BENCH_MAX_REPS : sweep->reps ;
+	if (reps == 0) return ;
+
+	first = 1 ;
+	if (sweep->format == BENCH_CSV) printf("strategy,bytes,src_offset,dst_offset,reps,min,median,max,ok\n") ;
+	else printf("[\n") ;
+
+	for (s = strategies; s < strategies + count; s++)
+		{
+		for (bytes = sweep->minBytes; bytes <= sweep->maxBytes && bytes <= BENCH_MAX_BYTES; bytes <<= 1)
+			{
+			for (soff = 0; soff < sweep->offsets && soff < 16; soff++)
+				{
+				for (doff = 0; doff < sweep->offsets && doff < 16; doff++)
+					{
+					if (!BenchSupports(s, bytes, soff, doff)) continue ;
+
+					ok = Measure(s, bytes, soff, doff, times, reps) ;
+					stats.min = times[0] ;
+					stats.median = times[reps/2] ;
+					stats.max = times[reps-1] ;
+					Report(sweep, s->label, bytes, soff, doff, &stats, ok) ;
+					}
+				}
+			}
+		}
+
+	if (sweep->format == BENCH_JSON) printf("\n]\n") ;
+	}
+
+int BenchSupports(const STRATEGY *s, uint32_t bytes, uint32_t soff, uint32_t doff)
+	{
+	if (s->kind == BENCH_FILL && soff != 0) return 0 ;	// src is not used
+	if (((soff ^ doff) % s->mutual) != 0) return 0 ;
+	return (soff % s->exact) == 0 && (doff % s->exact) == 0 && (bytes % s->exact) == 0 ;
+	}
+
+uint32_t BenchMin(const STRATEGY *s, uint32_t bytes, uint32_t soff, uint32_t doff, uint32_t reps)
+	{
+	uint32_t times[BENCH_MAX_REPS] ;
+
+	if (reps > BENCH_MAX_REPS) reps = BENCH_MAX_REPS ;
+	if (reps == 0 || bytes > BENCH_MAX_BYTES || soff >= 16 || doff >= 16) return UINT32_MAX ;
+	if (!BenchSupports(s, bytes, soff, doff)) return UINT32_MAX ;
+	return Measure(s, bytes, soff, doff, times, reps) ? times[0] : UINT32_MAX ;
+	}
+
+uint32_t BenchCheck(const STRATEGY *s, uint32_t maxBytes)
+	{
+	uint32_t bytes, soff, doff, k, errors ;
+	uint8_t *d ;
+
+	if (s->kind != BENCH_COPY) return 0 ;
+	if (maxBytes > BENCH_MAX_BYTES + 16 - 2*GUARD - 3) maxBytes = BENCH_MAX_BYTES + 16 - 2*GUARD - 3 ;
+	Prepare() ;
+
+	errors = 0 ;
+	for (soff = 0; soff < 4; soff++)
+		{
+		for (doff = 0; doff < 4; doff++)
+			{
+			d = dst + GUARD + doff ;
+			for (bytes = 0; bytes <= maxBytes; bytes++)
+				{
+				if (!BenchSupports(s, bytes, soff, doff)) continue ;
+
+				memset(dst, GUARD_BYTE, GUARD + doff + bytes + GUARD) ;
+				reference = NULL ;
+				(*s->copy)(d, src + soff, bytes) ;
+
+				for (k = 0; k < GUARD + doff; k++) if (dst[k] != GUARD_BYTE) break ;
+				if (k == GUARD + doff && memcmp(d, src + soff, bytes) == 0 && ChecksumOK(src + soff, bytes))
+					{
+					for (k = 0; k < GUARD; k++) if (d[bytes + k] != GUARD_BYTE) break ;
+					if (k == GUARD) continue ;
+					}
+				errors++ ;
+				}
+			}
+		}
+	return errors ;
+	}
+
+// Fills src and finds the timer overhead, once
+static void Prepare(void)
+	{
+	static int ready ;
+	uint32_t rep, strt, k ;
+
+	if (ready) return ;
+	for (k = 0; k < sizeof(src); k++) src[k] = k * 7 + (k >> 8) ;
+
+	ovhd = UINT32_MAX ;
+	for (rep = 0; rep < BENCH_MAX_REPS; rep++)
+		{
+		strt = Ticks() ;
+		strt = Ticks() - strt ;
+		if (strt < ovhd) ovhd = strt ;
+		}
+	ready = 1 ;
+	}
+
+// Times reps copies into times[] (sorted, less the timer overhead)
+// and returns nonzero if the copy was correct.
+static int Measure(const STRATEGY *s, uint32_t bytes, uint32_t soff, uint32_t doff, uint32_t times[], uint32_t reps)
+	{
+	uint32_t rep, strt, k ;
+
+	Prepare() ;
+	memset(dst, 0, bytes + 16) ;
+	if (s->kind == BENCH_COMPARE) memcpy(dst + doff, src + soff, bytes) ;
+	reference = NULL ;
+	for (rep = 0; rep < reps; rep++)
+		{
+		strt = Ticks() ;
+		(*s->copy)(dst + doff, src + soff, bytes) ;
+		times[rep] = Ticks() - strt ;
+		times[rep] = (times[rep] > ovhd) ? times[rep] - ovhd : 0 ;
+		}
+
+	Sort(times, reps) ;
+	switch (s->kind)
+		{
+		case BENCH_FILL:
+			for (k = 0; k < bytes; k++)
+				{
+				if (dst[doff + k] != BENCH_FILL_BYTE) return 0 ;
+				}
+			return 1 ;
+		case BENCH_COMPARE:
+			return compared == -1 ;
+		default:
+			return memcmp(dst + doff, src + soff, bytes) == 0 && ChecksumOK(src + soff, bytes) ;
+		}
+	}
+
+// Nonzero unless the last copy was a checksum adapter that returned
+// something other than the plain C checksum of s
+static int ChecksumOK(const uint8_t *s, uint32_t bytes)
+	{
+	return reference == NULL || checked == (*reference)(s, bytes) ;
+	}
+
+static void Report(const SWEEP *sweep, const char *label, uint32_t bytes, uint32_t soff, uint32_t doff, STATS *stats, int ok)
+	{
+	if (sweep->format == BENCH_CSV)
+		{
+		printf("%s,%u,%u,%u,%u,%u,%u,%u,%d\n", label, (unsigned) bytes, (unsigned) soff, (unsigned) doff,
+			(unsigned) sweep->reps, (unsigned) stats->min, (unsigned) stats->median, (unsigned) stats->max, ok) ;
+		return ;
+		}
+
+	printf("%s  {\"strategy\": \"%s\", \"bytes\": %u, \"src_offset\": %u, \"dst_offset\": %u, "
+		"\"reps\": %u, \"min\": %u, \"median\": %u, \"max\": %u, \"ok\": %s}",
+		first ? "" : ",\n", label, (unsigned) bytes, (unsigned) soff, (unsigned) doff, (unsigned) sweep->reps,
+		(unsigned) stats->min, (unsigned) stats->median, (unsigned) stats->max, ok ? "true" : "false") ;
+	first = 0 ;
+	}
+
+static void Sort(uint32_t times[], uint32_t count)
+	{
+	uint32_t k, j, t ;
+
+	// Insertion sort; count is small
+	for (k = 1; k < count; k++)
+		{
+		t = times[k] ;
+		for (j = k; j > 0 && times[j-1] > t; j--) times[j] = times[j-1] ;
+		times[j] = t ;
+		}
+	}
+
+static void ByteLoop(void *dst, const void *src, uint32_t bytes)
+	{
+	volatile uint8_t *d = dst ;
+	const uint8_t *s = src ;
+
+	while (bytes-- != 0) *d++ = *s++ ;
+	}
+
+static void Memcpy(void *dst, const void *src, uint32_t bytes)
+	{
+	memcpy(dst, src, bytes) ;
+	}
+
+static void Memset(void *dst, const void *src, uint32_t bytes)
+	{
+	(void) src ;
+	memset(dst, BENCH_FILL_BYTE, bytes) ;
+	}
+
+static void Memcmp(void *dst, const void *src, uint32_t bytes)
+	{
+	compared = (memcmp(dst, src, bytes) == 0) ? -1 : 0 ;
+	}
+
+#ifdef __arm__
+
+static void Fill(void *dst, const void *src, uint32_t bytes)
+	{
+	(void) src ;
+	FillBlock(dst, BENCH_FILL_BYTE, bytes) ;
+	}
+
+static void Pattern(void *dst, const void *src, uint32_t bytes)
+	{
+	(void) src ;
+	FillPattern(dst, BENCH_FILL_BYTE * 0x01010101u, bytes) ;
+	}
+
+static void Compare(void *dst, const void *src, uint32_t bytes)
+	{
+	compared = CompareBlock(dst, src, bytes) ;
+	}
+
+static uint32_t Ticks(void)
+	{
+	return GetClockCycleCount() ;
+	}
+
+#else
+
+static uint32_t Ticks(void)
+	{
+	return HarnessTicks() ;
+	}
+
+int main(void)
+	{
+	static const SWEEP sweep = {4, BENCH_MAX_BYTES, 4, 9, BENCH_CSV} ;
+	static const STRATEGY * const tables[] = {copyStrategies, checksumStrategies} ;
+	const uint32_t counts[] = {copyStrategyCount, checksumStrategyCount} ;
+	uint32_t t, k, errors ;
+
+	// Correctness first, on stderr so stdout stays CSV
+	for (t = 0; t < 2; t++)
+		{
+		for (k = 0; k < counts[t]; k++)
+			{
+			errors = BenchCheck(&tables[t][k], 4096) ;
+			fprintf(stderr, "%s: %u wrong copies\n", tables[t][k].label, (unsigned) errors) ;
+			if (errors != 0) return 1 ;
+			}
+		}
+
+	BenchSweep(&sweep, copyStrategies, copyStrategyCount) ;
+	BenchSweep(&sweep, fillStrategies, fillStrategyCount) ;
+	BenchSweep(&sweep, checksumStrategies, checksumStrategyCount) ;
+	return 0 ;
+	}
+
+#endif
@@ -0,0 +1,79 @@
+/*
+	Copy benchmark sweep: times each strategy over a range of sizes and
+	src/dst offsets and reports min/median/max time per configuration as
+	CSV or JSON on stdout. On the board times are CPU clock cycles; in a
+	host build (no __arm__) they are nanoseconds from HarnessTicks and
+	bench.c supplies its own main, which first runs BenchCheck on the
+	host's strategies (Lab 3 runs it on the board's when COPY_TEST is
+	defined):
+
+		gcc -O2 -I../Common -o bench bench.c checksum.c ../Common/harness.c && ./bench > sweep.csv
+*/
+
+#ifndef BENCH_H
+#define	BENCH_H
+
+#include <stdint.h>
+
+// The two buffers each take this much RAM, so a board build only has
+// room for a full sweep when BENCH_SWEEP is defined (for the whole
+// build, e.g. -DBENCH_SWEEP, so bench.c sees it too)
+#if defined(BENCH_SWEEP) || !defined(__arm__)
+#define	BENCH_MAX_BYTES	65536
+#else
+#define	BENCH_MAX_BYTES	4096
+#endif
+#define	BENCH_MAX_REPS	31
+#define	BENCH_FILL_BYTE	0xA5
+
+typedef enum
+	{
+	BENCH_CSV,
+	BENCH_JSON
+	} BENCH_FORMAT ;
+
+typedef enum
+	{
+	BENCH_COPY,			// Result must equal src
+	BENCH_FILL,			// Result must be all BENCH_FILL_BYTE
+	BENCH_COMPARE		// Given equal buffers; must find no difference
+	} BENCH_KIND ;
+
+typedef struct
+	{
+	const char *		label ;
+	void				(*copy)(void *dst, const void *src, uint32_t bytes) ;
+	uint32_t			mutual ;	// (dst ^ src) must be a multiple of this
+	uint32_t			exact ;		// dst, src & bytes must be multiples of this
+	BENCH_KIND			kind ;
+	} STRATEGY ;
+
+typedef struct
+	{
+	uint32_t			minBytes ;	// sizes swept in powers of two
+	uint32_t			maxBytes ;	// up to BENCH_MAX_BYTES
+	uint32_t			offsets ;	// src & dst offsets 0 .. offsets-1 (max 16)
+	uint32_t			reps ;		// timings per configuration (max BENCH_MAX_REPS)
+	BENCH_FORMAT		format ;
+	} SWEEP ;
+
+extern const STRATEGY	copyStrategies[] ;
+extern const uint32_t	copyStrategyCount ;
+extern const STRATEGY	fillStrategies[] ;
+extern const uint32_t	fillStrategyCount ;
+extern const STRATEGY	checksumStrategies[] ;
+extern const uint32_t	checksumStrategyCount ;
+
+extern void				BenchSweep(const SWEEP *sweep, const STRATEGY strategies[], uint32_t count) ;
+
+// One configuration (offsets 0..15): nonzero if s can run it, and its
+// fastest time over reps runs (UINT32_MAX if unsupported or incorrect)
+extern int				BenchSupports(const STRATEGY *s, uint32_t bytes, uint32_t soff, uint32_t doff) ;
+extern uint32_t			BenchMin(const STRATEGY *s, uint32_t bytes, uint32_t soff, uint32_t doff, uint32_t reps) ;
+
+// Every length 0..maxBytes at every src & dst offset 0..3 that s supports,
+// with guard bytes around dst; returns the number of wrong copies (or
+// wrong checksums, for the checksum strategies)
+extern uint32_t			BenchCheck(const STRATEGY *s, uint32_t maxBytes) ;
+
+#endif
@@ -0,0 +1,22 @@
+/*
+	Checksums, and copies that compute them on the way through. The
+	fused copies need word-aligned dst and src and a multiple of 4
+	bytes, and return what the plain checksum of src would.
+*/
+
+#ifndef CHECKSUM_H
+#define	CHECKSUM_H
+
+#include <stdint.h>
+
+// Plain checksums (src word aligned for Sum32, halfword for Fletcher32)
+extern uint32_t			Sum32(const void *src, uint32_t bytes) ;
+extern uint32_t			Fletcher32(const void *src, uint32_t bytes) ;
+extern uint32_t			Crc32(const void *src, uint32_t bytes) ;
+
+// Fused copy-and-checksum
+extern uint32_t			CopySum32(void *dst, const void *src, uint32_t bytes) ;
+extern uint32_t			CopyFletcher32(void *dst, const void *src, uint32_t bytes) ;
+extern uint32_t			CopyCrc32(void *dst, const void *src, uint32_t bytes) ;
+
+#endif
@@ -0,0 +1,131 @@
+// Fused copy and checksum: R0 = dst, R1 = src, R2 = bytes. dst and src
+// must be word aligned and bytes a multiple of 4 (as in UseLDM). Each
+// checksum is computed from the registers that carry the data to dst,
+// so memory is read only once. Returns the same value as Sum32,
+// Fletcher32 or Crc32 (checksum.c) applied to src.
+
+	.syntax	unified
+	.cpu	cortex-m4
+	.text
+
+	.global	CopySum32
+	.thumb_func
+CopySum32:
+	PUSH	{R4-R10}
+	MOV	R12,0			// sum
+	SUBS	R2,R2,32
+	BLO	stail
+sloop:	LDMIA	R1!,{R3-R10}		// 32 bytes per iteration
+	STMIA	R0!,{R3-R10}
+	ADD	R12,R12,R3
+	ADD	R12,R12,R4
+	ADD	R12,R12,R5
+	ADD	R12,R12,R6
+	ADD	R12,R12,R7
+	ADD	R12,R12,R8
+	ADD	R12,R12,R9
+	ADD	R12,R12,R10
+	SUBS	R2,R2,32
+	BHS	sloop
+stail:	ADDS	R2,R2,32		// 0-28 bytes left
+	BEQ	sdone
+sword:	LDR	R3,[R1],4
+	STR	R3,[R0],4
+	ADD	R12,R12,R3
+	SUBS	R2,R2,4
+	BNE	sword
+sdone:	MOV	R0,R12
+	POP	{R4-R10}
+	BX	LR
+
+// Fletcher-32 over little-endian halfwords. Both sums are folded
+// (hi + lo, which preserves them modulo 65535) after every block,
+// which keeps them well inside 32 bits.
+	.global	CopyFletcher32
+	.thumb_func
+CopyFletcher32:
+	PUSH	{R4-R11}
+	MOV	R11,0			// sum1
+	MOV	R12,0			// sum2
+	SUBS	R2,R2,32
+	BLO	ftail
+floop:	LDMIA	R1!,{R3-R10}		// 32 bytes per iteration
+	STMIA	R0!,{R3-R10}
+	.irp	reg,R3,R4,R5,R6,R7,R8,R9,R10
+	UXTAH	R11,R11,\reg		// low halfword
+	ADD	R12,R12,R11
+	ADD	R11,R11,\reg,LSR 16	// high halfword
+	ADD	R12,R12,R11
+	.endr
+	UXTH	R3,R11
+	ADD	R11,R3,R11,LSR 16
+	UXTH	R3,R12
+	ADD	R12,R3,R12,LSR 16
+	SUBS	R2,R2,32
+	BHS	floop
+ftail:	ADDS	R2,R2,32		// 0-28 bytes left
+	BEQ	fdone
+fword:	LDR	R3,[R1],4
+	STR	R3,[R0],4
+	UXTAH	R11,R11,R3
+	ADD	R12,R12,R11
+	ADD	R11,R11,R3,LSR 16
+	ADD	R12,R12,R11
+	SUBS	R2,R2,4
+	BNE	fword
+fdone:	UXTH	R3,R11			// two folds leave 0-65535
+	ADD	R11,R3,R11,LSR 16
+	UXTH	R3,R11
+	ADD	R11,R3,R11,LSR 16
+	UXTH	R3,R12
+	ADD	R12,R3,R12,LSR 16
+	UXTH	R3,R12
+	ADD	R12,R3,R12,LSR 16
+	MOVW	R3,65535		// and 65535 is the same as 0
+	CMP	R11,R3
+	IT	EQ
+	MOVEQ	R11,0
+	CMP	R12,R3
+	IT	EQ
+	MOVEQ	R12,0
+	ORR	R0,R11,R12,LSL 16
+	POP	{R4-R11}
+	BX	LR
+
+// CRC-32 (IEEE 802.3, reflected), one table lookup per byte
+	.global	CopyCrc32
+	.thumb_func
+CopyCrc32:
+	PUSH	{R4-R8}
+	LDR	R12,=crc32Table
+	MVN	R7,0			// crc = ~0
+	SUBS	R2,R2,16
+	BLO	ctail
+cloop:	LDMIA	R1!,{R3-R6}		// 16 bytes per iteration
+	STMIA	R0!,{R3-R6}
+	.irp	reg,R3,R4,R5,R6
+	EOR	R7,R7,\reg
+	.rept	4
+	UXTB	R8,R7
+	LDR	R8,[R12,R8,LSL 2]
+	EOR	R7,R8,R7,LSR 8
+	.endr
+	.endr
+	SUBS	R2,R2,16
+	BHS	cloop
+ctail:	ADDS	R2,R2,16		// 0-12 bytes left
+	BEQ	cdone
+cword:	LDR	R3,[R1],4
+	STR	R3,[R0],4
+	EOR	R7,R7,R3
+	.rept	4
+	UXTB	R8,R7
+	LDR	R8,[R12,R8,LSL 2]
+	EOR	R7,R8,R7,LSR 8
+	.endr
+	SUBS	R2,R2,4
+	BNE	cword
+cdone:	MVN	R0,R7
+	POP	{R4-R8}
+	BX	LR
+	.end
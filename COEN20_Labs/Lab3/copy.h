@@ -0,0 +1,21 @@
+/*
+	Block copy routines implemented in copy.s. All take the same
+	arguments as memcpy and accept any length.
+*/
+
+#ifndef COPY_H
+#define	COPY_H
+
+#include <stdint.h>
+
+// Any alignment: uses the widest transfer src & dst allow
+extern void				CopyBlock(void *dst, const void *src, uint32_t bytes) ;
+
+// Fixed transfer sizes; each aligns dst with head bytes first
+extern void				CopyLDRB(void *dst, const void *src, uint32_t bytes) ;
+extern void				CopyLDRH(void *dst, const void *src, uint32_t bytes) ;	// (dst ^ src) & 1 == 0
+extern void				CopyLDR(void *dst, const void *src, uint32_t bytes) ;	// (dst ^ src) & 3 == 0
+extern void				CopyLDRD(void *dst, const void *src, uint32_t bytes) ;	// (dst ^ src) & 3 == 0
+extern void				CopyLDM(void *dst, const void *src, uint32_t bytes) ;	// (dst ^ src) & 3 == 0
+
+#endif
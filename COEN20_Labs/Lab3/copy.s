@@ -0,0 +1,135 @@
+// Block copy for any length and alignment: R0 = dst, R1 = src, R2 = bytes.
+// CopyBlock picks the widest transfer the two addresses allow. The other
+// entry points force one transfer size; CopyLDRH needs (dst ^ src) & 1 == 0
+// and CopyLDR, CopyLDRD and CopyLDM need (dst ^ src) & 3 == 0. Each copies
+// head bytes until dst is aligned and finishes the tail with narrower moves.
+
+	.syntax	unified
+	.cpu	cortex-m4
+	.text
+
+	.global	CopyBlock
+	.thumb_func
+CopyBlock:
+	CMP	R2,16
+	BLO	CopyLDRB		// too short to be worth aligning
+	EOR	R3,R0,R1
+	TST	R3,1
+	BNE	CopyLDRB		// src & dst can never both be halfword aligned
+	TST	R3,2
+	BNE	CopyLDRH		// halfword aligned at best
+	B	CopyLDM			// word aligned after head bytes
+
+	.global	CopyLDRB
+	.thumb_func
+CopyLDRB:
+	SUBS	R2,R2,4
+	BLO	btail
+bloop:	LDRB	R3,[R1],1		// 4 bytes per iteration
+	STRB	R3,[R0],1
+	LDRB	R3,[R1],1
+	STRB	R3,[R0],1
+	LDRB	R3,[R1],1
+	STRB	R3,[R0],1
+	LDRB	R3,[R1],1
+	STRB	R3,[R0],1
+	SUBS	R2,R2,4
+	BHS	bloop
+btail:	ADDS	R2,R2,4			// 0-3 bytes left
+	BEQ	bdone
+bone:	LDRB	R3,[R1],1
+	STRB	R3,[R0],1
+	SUBS	R2,R2,1
+	BNE	bone
+bdone:	BX	LR
+
+	.global	CopyLDRH
+	.thumb_func
+CopyLDRH:
+	TST	R0,1
+	IT	NE
+	CMPNE	R2,0
+	BEQ	hbody			// dst aligned or nothing left
+	LDRB	R3,[R1],1
+	STRB	R3,[R0],1
+	SUBS	R2,R2,1
+hbody:	SUBS	R2,R2,2
+	BLO	htail
+hloop:	LDRH	R3,[R1],2
+	STRH	R3,[R0],2
+	SUBS	R2,R2,2
+	BHS	hloop
+htail:	ADDS	R2,R2,2			// 0-1 bytes left
+	B	CopyLDRB
+
+	.global	CopyLDR
+	.thumb_func
+CopyLDR:
+whead:	TST	R0,3
+	IT	NE
+	CMPNE	R2,0
+	BEQ	wbody			// dst aligned or nothing left
+	LDRB	R3,[R1],1
+	STRB	R3,[R0],1
+	SUBS	R2,R2,1
+	B	whead
+wbody:	SUBS	R2,R2,4
+	BLO	wtail
+wloop:	LDR	R3,[R1],4
+	STR	R3,[R0],4
+	SUBS	R2,R2,4
+	BHS	wloop
+wtail:	ADDS	R2,R2,4			// 0-3 bytes left
+	B	CopyLDRB
+
+	.global	CopyLDRD
+	.thumb_func
+CopyLDRD:
+dhead:	TST	R0,3
+	IT	NE
+	CMPNE	R2,0
+	BEQ	dbody			// dst aligned or nothing left
+	LDRB	R3,[R1],1
+	STRB	R3,[R0],1
+	SUBS	R2,R2,1
+	B	dhead
+dbody:	SUBS	R2,R2,8
+	BLO	dtail
+dloop:	LDRD	R3,R12,[R1],8
+	STRD	R3,R12,[R0],8
+	SUBS	R2,R2,8
+	BHS	dloop
+dtail:	ADDS	R2,R2,8			// 0-7 bytes left
+	B	wbody
+
+	.global	CopyLDM
+	.thumb_func
+CopyLDM:
+mhead:	TST	R0,3
+	IT	NE
+	CMPNE	R2,0
+	BEQ	mbody			// dst aligned or nothing left
+	LDRB	R3,[R1],1
+	STRB	R3,[R0],1
+	SUBS	R2,R2,1
+	B	mhead
+mbody:	CMP	R2,32
+	BLO	wbody			// less than one LDM block
+	PUSH	{R4-R10}
+	SUBS	R2,R2,64
+	BMI	mlast
+mloop:	LDMIA	R1!,{R3-R10}		// 64 bytes per iteration
+	STMIA	R0!,{R3-R10}
+	LDMIA	R1!,{R3-R10}
+	STMIA	R0!,{R3-R10}
+	SUBS	R2,R2,64
+	BPL	mloop
+mlast:	ADDS	R2,R2,64		// 0-63 bytes left
+	CMP	R2,32
+	BLO	mdone
+	LDMIA	R1!,{R3-R10}
+	STMIA	R0!,{R3-R10}
+	SUBS	R2,R2,32
+mdone:	POP	{R4-R10}
+	B	wbody			// 0-31 bytes left
+	.end
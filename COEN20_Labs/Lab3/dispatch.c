@@ -0,0 +1,137 @@
+/*
+	Copy dispatcher.
+
+	Each bucket is calibrated with a copy of exactly its power-of-two
+	size at offsets that put it in its alignment class, and keeps the
+	strategy with the lowest best-case time. Looking up a copy costs a
+	count-leading-zeros and a two-dimensional table index.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "dispatch.h"
+
+static uint32_t			Class(uint32_t dst, uint32_t src, uint32_t bytes) ;
+static uint32_t			Size(uint32_t bytes) ;
+static void				Memcpy(void *dst, const void *src, uint32_t bytes) ;
+
+// src & dst offsets that land a calibration copy in each class
+static const uint8_t	offsets[DISPATCH_CLASSES][2] =
+	{
+	{0, 1},		// (dst ^ src) & 1
+	{0, 2},		// (dst ^ src) & 2
+	{1, 1},		// word mutual, not word aligned
+	{0, 0}		// dst, src and bytes all word multiples
+	} ;
+
+static const STRATEGY	fallback = {"mcpy", Memcpy, 1, 1, BENCH_COPY} ;
+
+static DISPATCH_TABLE	table ;
+static const STRATEGY *	active ;	// NULL until calibrated or loaded
+
+void DispatchCalibrate(const STRATEGY strategies[], uint32_t count, uint32_t reps)
+	{
+	uint32_t cls, size, bytes, best, time, k ;
+
+	active = NULL ;
+	table.magic = DISPATCH_MAGIC ;
+	table.count = count ;
+	for (cls = 0; cls < DISPATCH_CLASSES; cls++)
+		{
+		for (size = 0; size < DISPATCH_SIZES; size++)
+			{
+			bytes = 1 << size ;
+			if (bytes > BENCH_MAX_BYTES)
+				{
+				table.choice[cls][size] = table.choice[cls][size - 1] ;
+				continue ;
+				}
+
+			best = UINT32_MAX ;
+			table.choice[cls][size] = 0 ;
+			for (k = 0; k < count && k < 256; k++)
+				{
+				time = BenchMin(&strategies[k], bytes, offsets[cls][0], offsets[cls][1], reps) ;
+				if (time < best)
+					{
+					best = time ;
+					table.choice[cls][size] = k ;
+					}
+				}
+			}
+		}
+	active = strategies ;
+	}
+
+int DispatchLoad(const DISPATCH_TABLE *saved, const STRATEGY strategies[], uint32_t count)
+	{
+	uint32_t cls, size ;
+
+	if (saved->magic != DISPATCH_MAGIC || saved->count != count) return 0 ;
+	for (cls = 0; cls < DISPATCH_CLASSES; cls++)
+		{
+		for (size = 0; size < DISPATCH_SIZES; size++)
+			{
+			if (saved->choice[cls][size] >= count) return 0 ;
+			}
+		}
+
+	memcpy(&table, saved, sizeof(table)) ;
+	active = strategies ;
+	return 1 ;
+	}
+
+void DispatchSave(DISPATCH_TABLE *saved)
+	{
+	memcpy(saved, &table, sizeof(table)) ;
+	}
+
+const STRATEGY *DispatchChoice(const void *dst, const void *src, uint32_t bytes)
+	{
+	uint32_t cls ;
+
+	if (active == NULL || bytes > DISPATCH_MAX_BYTES) return &fallback ;
+	cls = Class((uintptr_t) dst, (uintptr_t) src, bytes) ;
+	return &active[table.choice[cls][Size(bytes)]] ;
+	}
+
+void CopyAuto(void *dst, const void *src, uint32_t bytes)
+	{
+	uint8_t *d = dst ;
+	const uint8_t *s = src ;
+
+	// Pieces keep the alignment class, as DISPATCH_MAX_BYTES is a word multiple
+	while (bytes > DISPATCH_MAX_BYTES)
+		{
+		(*DispatchChoice(d, s, DISPATCH_MAX_BYTES)->copy)(d, s, DISPATCH_MAX_BYTES) ;
+		d += DISPATCH_MAX_BYTES ;
+		s += DISPATCH_MAX_BYTES ;
+		bytes -= DISPATCH_MAX_BYTES ;
+		}
+	(*DispatchChoice(d, s, bytes)->copy)(d, s, bytes) ;
+	}
+
+static uint32_t Class(uint32_t dst, uint32_t src, uint32_t bytes)
+	{
+	uint32_t diff = dst ^ src ;
+
+	if (diff & 1) return 0 ;
+	if (diff & 2) return 1 ;
+	if ((dst | bytes) & 3) return 2 ;
+	return 3 ;
+	}
+
+static uint32_t Size(uint32_t bytes)
+	{
+	uint32_t size ;
+
+	if (bytes < 2) return 0 ;
+	size = 31 - __builtin_clz(bytes) ;		// bytes <= DISPATCH_MAX_BYTES
+	return size ;
+	}
+
+static void Memcpy(void *dst, const void *src, uint32_t bytes)
+	{
+	memcpy(dst, src, bytes) ;
+	}
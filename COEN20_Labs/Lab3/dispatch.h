@@ -0,0 +1,45 @@
+/*
+	Copy dispatcher: CopyAuto sends each copy to whichever strategy was
+	fastest, when measured, for its size and alignment bucket. Measure
+	once at startup with DispatchCalibrate, or install a table saved
+	from an earlier run (it is plain data, e.g. a const in flash) with
+	DispatchLoad. Until one of those succeeds CopyAuto uses memcpy.
+	Calibration times copies up to BENCH_MAX_BYTES; larger buckets take
+	the choice for the largest size timed, since by then every strategy
+	is streaming at its steady rate.
+
+	Buckets are the power of two at or below the length (1 B to 64 KB)
+	crossed with four alignment classes, from "src and dst differ in bit
+	0" to "src, dst and length all word multiples" (the only class DMA
+	can serve). No strategy is handed more than DISPATCH_MAX_BYTES, the
+	top bucket's size (and well under DMA_MAX_BYTES): CopyAuto
+	copies longer blocks in pieces of that size, and DispatchChoice
+	returns memcpy for them.
+*/
+
+#ifndef DISPATCH_H
+#define	DISPATCH_H
+
+#include <stdint.h>
+#include "bench.h"
+
+#define	DISPATCH_SIZES		17		// 2^0 .. 2^16 bytes
+#define	DISPATCH_CLASSES	4
+#define	DISPATCH_MAX_BYTES	(1 << (DISPATCH_SIZES - 1))
+#define	DISPATCH_MAGIC		0x44535054	// "DSPT"
+
+typedef struct
+	{
+	uint32_t			magic ;
+	uint32_t			count ;		// Strategies in the table it indexes
+	uint8_t				choice[DISPATCH_CLASSES][DISPATCH_SIZES] ;
+	} DISPATCH_TABLE ;
+
+extern void				DispatchCalibrate(const STRATEGY strategies[], uint32_t count, uint32_t reps) ;
+extern int				DispatchLoad(const DISPATCH_TABLE *table, const STRATEGY strategies[], uint32_t count) ;
+extern void				DispatchSave(DISPATCH_TABLE *table) ;
+extern const STRATEGY *	DispatchChoice(const void *dst, const void *src, uint32_t bytes) ;
+
+extern void				CopyAuto(void *dst, const void *src, uint32_t bytes) ;
+
+#endif
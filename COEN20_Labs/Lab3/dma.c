@@ -0,0 +1,341 @@
+/*
+	Memory-to-memory DMA on DMA2 stream 0.
+
+	Bursts of four words must not cross a 1KB boundary, so bursts are
+	only enabled when both addresses are 16-byte aligned (a 16-byte
+	aligned burst can never straddle a 1KB boundary) and the length is a
+	whole number of bursts; otherwise the stream moves single words.
+
+	Submitted requests form a queue whose head is being copied one chunk
+	at a time. On the board each transfer-complete interrupt starts the
+	next chunk. A host build has no DMA controller, so a worker thread
+	takes its place and copies each chunk with memcpy while the caller
+	runs.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include "dma.h"
+
+#ifndef __arm__
+#include <string.h>
+#include <pthread.h>
+#endif
+
+static DMA_REQUEST *	ChunkDone(void) ;
+static uint32_t			ChunkSize(const DMA_REQUEST *req) ;
+static void				Lock(void) ;
+static void				StartChunk(void) ;
+static void				Unlock(void) ;
+
+static DMA_REQUEST * volatile head ;		// Request being copied
+static DMA_REQUEST *	tail ;		// Last request submitted
+static uint32_t			chunk ;		// Bytes in flight for head
+
+void DMA_Submit(DMA_REQUEST *req, void *dst, const void *src, uint32_t bytes, DMA_CALLBACK done, void *context)
+	{
+	req->next		= NULL ;
+	req->dst		= dst ;
+	req->src		= src ;
+	req->bytes		= bytes ;
+	req->done		= done ;
+	req->context	= context ;
+
+	if (bytes == 0)
+		{
+		req->busy = 0 ;
+		if (done != NULL) (*done)(context) ;
+		return ;
+		}
+
+	req->busy = 1 ;
+	Lock() ;
+	if (head == NULL)
+		{
+		head = tail = req ;
+		StartChunk() ;
+		}
+	else
+		{
+		tail->next = req ;
+		tail = req ;
+		}
+	Unlock() ;
+	}
+
+int DMA_Poll(const DMA_REQUEST *req)
+	{
+	return !req->busy ;
+	}
+
+// Account for the chunk that just landed and start the next one.
+// Returns the request that finished, if any, so the caller can run
+// its callback once the queue is consistent again.
+static DMA_REQUEST *ChunkDone(void)
+	{
+	DMA_REQUEST *req = head ;
+
+	req->dst += chunk ;
+	req->src += chunk ;
+	req->bytes -= chunk ;
+	if (req->bytes != 0)
+		{
+		StartChunk() ;
+		return NULL ;
+		}
+
+	head = req->next ;
+	if (head == NULL) tail = NULL ;
+	else StartChunk() ;
+	req->busy = 0 ;
+	return req ;
+	}
+
+static uint32_t ChunkSize(const DMA_REQUEST *req)
+	{
+	uint32_t bytes, room ;
+
+	// Stop at whichever 1KB boundary comes first
+	bytes = req->bytes ;
+	room = DMA_CHUNK_BYTES - ((uintptr_t) req->src & (DMA_CHUNK_BYTES - 1)) ;
+	if (room < bytes) bytes = room ;
+	room = DMA_CHUNK_BYTES - ((uintptr_t) req->dst & (DMA_CHUNK_BYTES - 1)) ;
+	if (room < bytes) bytes = room ;
+	return bytes ;
+	}
+
+#ifdef __arm__
+
+typedef struct
+	{
+	uint32_t			CR ;		// Configuration register
+	uint32_t			NDTR ;		// Number of data items register
+	const void *		PAR ;		// Peripheral (source) address register
+	void *				M0AR ;		// Memory 0 (destination) address register
+	void *				M1AR ;		// Memory 1 address register
+	uint32_t			FCR ;		// FIFO control register
+	} DMA_STREAM ;
+
+static		uint32_t	const MBURST		= (1 << 23) ;	// Write burst of 4 beats
+static		uint32_t	const PBURST		= (1 << 21) ;	// Read burst of 4 beats
+static		uint32_t	const MSIZE			= (2 << 13) ;	// Write 32-bit words
+static		uint32_t	const PSIZE			= (2 << 11) ;	// Read 32-bit words
+static		uint32_t	const MINC			= (1 << 10) ;	// Autoincr dst adrs
+static		uint32_t	const PINC			= (1 <<  9) ;	// Autoincr src adrs
+static		uint32_t	const DIR			= (2 <<  6) ;	// Memory-To-Memory
+static		uint32_t	const TCIE			= (1 <<  4) ;	// Transfer complete interrupt enable
+static		uint32_t	const EN			= (1 <<  0) ;	// "Go"
+static		uint32_t	const FTH			= (3 <<  0) ;	// FIFO threshold = full
+static		uint32_t	const DMDIS			= (1 <<  2) ;	// Direct mode disabled
+static		uint32_t	const TCIF0			= (1 <<  5) ;	// Transfer complete flag
+static		uint32_t	const IRQ_BIT		= (1 << 24) ;	// DMA2_Stream0 is IRQ 56
+static volatile uint32_t *	const pDMA2_LISR	= (uint32_t *)		0x40026400 ;
+static volatile uint32_t *	const pDMA2_LIFCR	= (uint32_t *)		0x40026408 ;
+static volatile DMA_STREAM *const DMA2_S0		= (DMA_STREAM *)	0x40026410 ;
+static volatile uint32_t *	const pRCC_AHB1ENR	= (uint32_t *)		0x40023830 ;
+static volatile uint32_t *	const pNVIC_ISER1	= (uint32_t *)		0xE000E104 ;
+
+static uint32_t			primask ;
+static uint32_t			ready ;		// CR value that starts a prepared copy
+
+// Everything but the write that sets EN; returns the CR value for it
+static uint32_t Configure(void *dst, const void *src, uint32_t bytes)
+	{
+	uint32_t burst ;
+
+	burst = ((((uint32_t) dst | (uint32_t) src | bytes) & 0xF) == 0) ? (MBURST|PBURST) : 0 ;
+
+	*pRCC_AHB1ENR |= (1 << 22) ; 			// Enable DMA Clock
+
+	DMA2_S0->CR		= 0 ; 					// Disable DMA
+	DMA2_S0->PAR	= src ; 				// Setup src address
+	DMA2_S0->M0AR	= dst ; 				// Setup dst address
+	DMA2_S0->NDTR	= bytes/4 ; 			// Setup word count
+	DMA2_S0->FCR	= DMDIS|FTH ;			// Setup FIFO
+
+	*pDMA2_LIFCR	= TCIF0 ;				// Clear TCIF0
+	while ((*pDMA2_LISR & TCIF0) != 0) ;	// wait for TCIF0 = 0
+
+	return burst|MSIZE|PSIZE|MINC|PINC|DIR|EN ;
+	}
+
+static void Start(void *dst, const void *src, uint32_t bytes, uint32_t irq)
+	{
+	DMA2_S0->CR = Configure(dst, src, bytes) | irq ;
+	}
+
+void DMA_Copy(void *dst, const void *src, uint32_t bytes)
+	{
+	uint32_t piece ;
+
+	// NDTR counts at most DMA_MAX_BYTES/4 words. Whole pieces are a
+	// multiple of 16 bytes so those after the first can still burst.
+	while (bytes != 0)
+		{
+		piece = bytes < DMA_MAX_BYTES ? bytes : (DMA_MAX_BYTES & ~0xF) ;
+		DMA_Prepare(dst, src, piece) ;
+		DMA_Run() ;
+		dst = (uint8_t *) dst + piece ;
+		src = (const uint8_t *) src + piece ;
+		bytes -= piece ;
+		}
+	}
+
+void DMA_Prepare(void *dst, const void *src, uint32_t bytes)
+	{
+	ready = 0 ;
+	if (bytes == 0) return ;
+	while (head != NULL) ;					// Queued copies own the stream
+
+	ready = Configure(dst, src, bytes) ;
+	}
+
+void DMA_Run(void)
+	{
+	if (ready == 0) return ;
+	DMA2_S0->CR = ready ;
+	while ((*pDMA2_LISR & TCIF0) == 0) ;	// wait for TCIF0 = 1
+	}
+
+void DMA_Wait(const DMA_REQUEST *req)
+	{
+	while (req->busy) ;
+	}
+
+void DMA2_Stream0_IRQHandler(void)
+	{
+	DMA_CALLBACK done ;
+	void *context ;
+
+	if ((*pDMA2_LISR & TCIF0) == 0) return ;
+	*pDMA2_LIFCR = TCIF0 ;
+
+	// Once busy drops the request belongs to the caller again
+	done = head->done ;
+	context = head->context ;
+	if (ChunkDone() != NULL && done != NULL) (*done)(context) ;
+	}
+
+static void StartChunk(void)
+	{
+	*pNVIC_ISER1 = IRQ_BIT ;
+	chunk = ChunkSize(head) ;
+	Start(head->dst, head->src, chunk, TCIE) ;
+	}
+
+// Keep the interrupt out while the queue is changed; callbacks
+// submit from inside the interrupt, so restore rather than enable.
+static void Lock(void)
+	{
+	uint32_t saved ;
+
+	__asm volatile ("MRS %0,PRIMASK\n\tCPSID i" : "=r" (saved) : : "memory") ;
+	primask = saved ;
+	}
+
+static void Unlock(void)
+	{
+	__asm volatile ("MSR PRIMASK,%0" : : "r" (primask) : "memory") ;
+	}
+
+#else
+
+static void *			Worker(void *arg) ;
+
+static pthread_mutex_t	mutex = PTHREAD_MUTEX_INITIALIZER ;
+static pthread_cond_t	work = PTHREAD_COND_INITIALIZER ;	// head != NULL
+static pthread_cond_t	idle = PTHREAD_COND_INITIALIZER ;	// a request finished
+static pthread_once_t	once = PTHREAD_ONCE_INIT ;
+
+// The copy DMA_Prepare set up
+static void *			readyDst ;
+static const void *		readySrc ;
+static uint32_t			readyBytes ;
+
+static void Launch(void)
+	{
+	pthread_t thread ;
+
+	pthread_create(&thread, NULL, Worker, NULL) ;
+	pthread_detach(thread) ;
+	}
+
+void DMA_Copy(void *dst, const void *src, uint32_t bytes)
+	{
+	DMA_REQUEST req ;
+
+	DMA_Submit(&req, dst, src, bytes, NULL, NULL) ;
+	DMA_Wait(&req) ;
+	}
+
+void DMA_Prepare(void *dst, const void *src, uint32_t bytes)
+	{
+	readyDst = dst ;
+	readySrc = src ;
+	readyBytes = bytes ;
+	}
+
+void DMA_Run(void)
+	{
+	DMA_Copy(readyDst, readySrc, readyBytes) ;
+	readyBytes = 0 ;
+	}
+
+void DMA_Wait(const DMA_REQUEST *req)
+	{
+	pthread_mutex_lock(&mutex) ;
+	while (req->busy) pthread_cond_wait(&idle, &mutex) ;
+	pthread_mutex_unlock(&mutex) ;
+	}
+
+// Plays the part of the DMA controller
+static void *Worker(void *arg)
+	{
+	DMA_REQUEST *req ;
+	DMA_CALLBACK done ;
+	void *context ;
+
+	(void) arg ;
+	pthread_mutex_lock(&mutex) ;
+	while (1)
+		{
+		while (head == NULL) pthread_cond_wait(&work, &mutex) ;
+
+		// Copy without the lock, as the hardware would
+		req = head ;
+		pthread_mutex_unlock(&mutex) ;
+		memcpy(req->dst, req->src, chunk) ;
+		pthread_mutex_lock(&mutex) ;
+
+		// Once busy drops the request belongs to the caller again
+		done = req->done ;
+		context = req->context ;
+		if (ChunkDone() == NULL) continue ;
+		pthread_cond_broadcast(&idle) ;
+		if (done == NULL) continue ;
+
+		pthread_mutex_unlock(&mutex) ;
+		(*done)(context) ;
+		pthread_mutex_lock(&mutex) ;
+		}
+	return NULL ;
+	}
+
+static void StartChunk(void)
+	{
+	chunk = ChunkSize(head) ;
+	pthread_cond_signal(&work) ;
+	}
+
+static void Lock(void)
+	{
+	pthread_once(&once, Launch) ;
+	pthread_mutex_lock(&mutex) ;
+	}
+
+static void Unlock(void)
+	{
+	pthread_mutex_unlock(&mutex) ;
+	}
+
+#endif
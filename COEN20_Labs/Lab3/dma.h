@@ -0,0 +1,55 @@
+/*
+	Memory-to-memory copies on DMA2 stream 0 (the stream Lab 3 uses).
+	src and dst must be word aligned and bytes a multiple of 4.
+
+	DMA_Copy busy-waits, and copies of any length go in pieces of at most
+	DMA_MAX_BYTES. DMA_Prepare and DMA_Run are its two halves for one
+	piece, so the transfer can be timed apart from setting up the stream;
+	DMA_Prepare must not be given more than DMA_MAX_BYTES.
+
+	DMA_Submit queues a copy and returns at once so the caller can
+	compute while the copy runs; check it with DMA_Poll, block on it with
+	DMA_Wait, or have the callback run when it lands. Requests are copied
+	in the order submitted and each is split into chunks that never cross
+	a 1KB boundary of src or dst. The callback runs in the DMA interrupt
+	(on the board) or the worker thread that stands in for the DMA engine
+	(in a host build) and may submit more requests, including the one
+	that just finished.
+*/
+
+#ifndef DMA_H
+#define	DMA_H
+
+#include <stdint.h>
+
+#define	DMA_MAX_BYTES	(65535*4)	// NDTR is a 16-bit word count
+#define	DMA_CHUNK_BYTES	1024		// Bursts cannot cross a 1KB boundary
+
+typedef void			(*DMA_CALLBACK)(void *context) ;
+
+// Owned by dma.c from DMA_Submit until busy drops to zero
+typedef struct DMA_REQUEST
+	{
+	struct DMA_REQUEST *next ;		// Queue link
+	uint8_t *			dst ;		// Advanced as chunks complete
+	const uint8_t *		src ;
+	uint32_t			bytes ;		// Still to be copied
+	DMA_CALLBACK		done ;		// NULL if not wanted
+	void *				context ;	// Passed to done
+	volatile int		busy ;
+	} DMA_REQUEST ;
+
+// Copy and busy-wait for completion
+extern void				DMA_Copy(void *dst, const void *src, uint32_t bytes) ;
+
+// One piece of DMA_Copy (bytes <= DMA_MAX_BYTES) in two steps: set up
+// the stream, then start it and busy-wait
+extern void				DMA_Prepare(void *dst, const void *src, uint32_t bytes) ;
+extern void				DMA_Run(void) ;
+
+// Asynchronous copies
+extern void				DMA_Submit(DMA_REQUEST *req, void *dst, const void *src, uint32_t bytes, DMA_CALLBACK done, void *context) ;
+extern int				DMA_Poll(const DMA_REQUEST *req) ;	// Nonzero once complete
+extern void				DMA_Wait(const DMA_REQUEST *req) ;
+
+#endif
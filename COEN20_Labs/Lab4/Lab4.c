@@ -13,6 +13,13 @@
 #include <memory.h>
 #include "library.h"
 #include "graphics.h"
+#include "scale.h"
+#include "calib.h"
+#include "filter.h"
+#include "history.h"
+#include "strip.h"
+#include "adcdma.h"
+#include "pipeline.h"
 
 #define	PLOT_YMIN		204
 #define PLOT_YMAX		297
@@ -22,7 +29,12 @@
 #define PLOT_XMAX		219
 #define	PLOT_WIDTH		(PLOT_XMAX - PLOT_XMIN + 1)
 
-#define	FILTER_SAMPLES	5
+#define	PLOT_PAD_C		1		// Degrees of headroom above & below the data
+#define	PLOT_LABELS		16
+
+#define	FILTER_TYPE		FILTER_AVERAGE	// or FILTER_EMA, FILTER_MEDIAN
+#define	FILTER_SAMPLES	5				// depth, or shift for FILTER_EMA
+#define	VREF_TOLERANCE	50				// Alarm if Vref drifts by more than 1/50
 
 // Function to implement in assembly: Returns (mtop*x + mbtm/2)/mbtm + b
 extern int32_t MxPlusB(int32_t x, int32_t mtop, int32_t mbtm, int32_t b) ;
@@ -82,14 +94,18 @@ typedef struct
 
 typedef struct
 	{
-	int32_t				samples ;
-	int32_t				rawX100[PLOT_WIDTH] ;
-	int32_t				fltX100[PLOT_WIDTH] ;
+	HISTORY				history ;	// Filtered readings, oldest first
 	int32_t				minX100 ;
 	int32_t				maxX100 ;
 	float				yScale ;
 	int32_t				minC ;
 	int32_t				maxC ;
+	WINDOW				window ;	// Min & max of history
+	int16_t				rows[HISTORY_SIZE] ;	// Pixel row of each sample, by HistorySlot
+	int32_t				labels ;			// Vertical scale labels on screen
+	int16_t				labelC[PLOT_LABELS] ;
+	int16_t				labelY[PLOT_LABELS] ;
+	int32_t				textY ;				// Where the readings are shown
 	} PLOT_DATA ;
 
 // Public fonts defined in run-time library
@@ -108,6 +124,10 @@ static ADC_CHANNEL *	ADC1		=	(ADC_CHANNEL *)	0x40012000 ;
 static ADC_COMMON *		ADC  		= 	(ADC_COMMON  *)	0x40012300 ;
 static RSTCLKCTL *		RCC			=	(RSTCLKCTL *) 	0x40023800 ;
 
+// Off-screen copy of the plot, scrolled by moving a column offset
+static uint32_t			stripPixels[PLOT_WIDTH * PLOT_HEIGHT] ;
+static STRIP			strip ;
+
 #define	ADC1_EN			(1 << 8)
 #define	ADC1_EOC		(1 << 1)
 #define	ADC1_LEN		(1 << 20)
@@ -123,28 +143,53 @@ static int32_t			ADC_Reading(int32_t channel) ;
 static void				DelayMS(uint32_t msec) ;
 static uint32_t			GetTimeout(uint32_t msec) ;
 static void				LEDs(int grn_on, int red_on) ;
-static int32_t			LowPassFilter(PLOT_DATA *plot, int depth) ;
 static int32_t			PutStringAt(int32_t x, int32_t y, char *fmt, ...) ;
-static void				PlotDegreesC(PLOT_DATA *plot, int sample) ;
+static void				Labels(PLOT_DATA *plot) ;
+static void				PlotDegreesC(PLOT_DATA *plot) ;
+static void				PlotSink(PIPE_CHANNEL *channel, int32_t degreesC) ;
+static void				PlotSegment(int sample, int samples, int yold, int ynew) ;
 static uint32_t *		PixelAddress(uint32_t x, uint32_t y) ;
 static void				Rescale(PLOT_DATA *plot) ;
+static int				Row(const PLOT_DATA *plot, int32_t x100) ;
 static BOOL				SanityChecksOK(void) ;
+static int				ScaleMismatches(int32_t first[6]) ;
 static void				SetFontSize(sFONT *Font) ;
-static void				ShiftPlotLeft(void) ;
 static BOOL				UpdateData(PLOT_DATA *plot, int32_t degrX100) ;
+static void				VrefAlarm(int active) ;
 
 #define	ENTRIES(a)		(sizeof(a)/sizeof(a[0]))
 
 int main(void)
 	{
 	int32_t curVref, calVref, cal030, cal110, scaled110 ;
-	int32_t rawTemp, scaled030, y, savey, degreesC ;
+	int32_t scaled030, y ;
+	int32_t cal[2], scaled[2] ;
+	static const CALIB_POINT unscaled[] = {{0, 0}, {4095, 4095}} ;
 	static PLOT_DATA plot = {0} ;
+	static CALIB_POINT points[2] ;
+	static PIPE_ALARM drift ;
+	static PIPELINE pipeline ;
+
+	// One entry per channel, in scan order
+	static const PIPE_SPEC specs[] =
+		{
+		{"Vref", ADC1_IN17, unscaled, ENTRIES(unscaled), FILTER_AVERAGE, 4, ADC_BLOCK_SCANS, SinkAlarm, &drift},
+		{"Temp", ADC1_IN18, points, ENTRIES(points), FILTER_TYPE, FILTER_SAMPLES, ADC_BLOCK_SCANS, PlotSink, &plot}
+		} ;
+	SCALE vref ;
 
 	InitializeHardware(NULL, "Lab 4c: Linear Interpolation") ;
 	ADC_Init() ;
 	if (!SanityChecksOK()) return 0 ;
 
+	HistoryInit(&plot.history, PLOT_WIDTH) ;
+	WindowInit(&plot.window, PLOT_WIDTH) ;
+	StripInit(&strip, PixelAddress(PLOT_XMIN, PLOT_YMIN), XPIXELS, stripPixels, PLOT_WIDTH, PLOT_HEIGHT) ;
+
+	// Outline of graph
+	SetForeground(COLOR_BLACK) ;
+	DrawRect(PLOT_XMIN - 1, PLOT_YMIN - 1, PLOT_WIDTH + 1, PLOT_HEIGHT) ;
+
 	curVref = ADC_Reading(ADC1_IN17) ;			// Get current reference voltage reading
 	calVref = CALIBRATION->VREFIN_CAL ;			// Get calibrated reference voltage reading
 
@@ -152,8 +197,29 @@ int main(void)
 	cal110 = CALIBRATION->TEMP_3V3_110C ;		// Get calibrated temp reading for 110 degrees C
 
 	// Scale calibrated temp readings to current reference voltage
-	scaled030 = MxPlusB(cal030, curVref, calVref, 0) ;
-	scaled110 = MxPlusB(cal110, curVref, calVref, 0) ;
+	cal[0] = cal030 ;
+	cal[1] = cal110 ;
+	ScaleInit(&vref, curVref, calVref, 0) ;
+	ScaleSamples(&vref, scaled, cal, 2) ;
+	scaled030 = scaled[0] ;
+	scaled110 = scaled[1] ;
+
+	// Two-point table from the factory calibration; more points
+	// (e.g. from a reference thermometer) can be added here
+	points[0].raw = scaled030 ;	points[0].value =  3000 ;
+	points[1].raw = scaled110 ;	points[1].value = 11000 ;
+
+	// Vref raises the red LED if it drifts from its value at startup
+	drift.low			= curVref - curVref/VREF_TOLERANCE ;
+	drift.high			= curVref + curVref/VREF_TOLERANCE ;
+	drift.hysteresis	= curVref/(4*VREF_TOLERANCE) ;
+	drift.notify		= VrefAlarm ;
+
+	if (!PipelineInit(&pipeline, specs, ENTRIES(specs)))
+		{
+		printf("Bad calibration: %d, %d\n", (int) scaled030, (int) scaled110) ;
+		return 0 ;
+		}
 
 	SetFontSize(&FONT) ;
 	y = 50 ;
@@ -183,164 +249,194 @@ int main(void)
 	y = PutStringAt(20, y, "      Scaled (110C): %5d", (int) scaled110) ;
 	y += 4 ;
 
-	savey = y ;
+	plot.textY = y ;
+
+	// From here on the ADC scans continuously and paces the loop;
+	// the sinks update the display
+	PipelineStart(&pipeline) ;
 	while (1)
 		{
-		y = savey ;
-
-		// Get raw temp reading from A/D converter
-		rawTemp = ADC_Reading(ADC1_IN18) ;
-
-		SetForeground(COLOR_BLACK) ;
-		SetBackground(COLOR_LIGHTGREEN) ;
-		y = PutStringAt(20, y, "    Raw A/D Reading: %5d", (int) rawTemp) ;
-
-		// Convert to temp in degrees C (times 100)
-		degreesC = MxPlusB(rawTemp - scaled030, 8000, scaled110 - scaled030, 3000) ;
-
-		if (UpdateData(&plot, degreesC)) Rescale(&plot) ;
-		ShiftPlotLeft() ;
-		PlotDegreesC(&plot, plot.samples - 1) ;
-
-		SetForeground(COLOR_BLACK) ;
-		SetBackground(COLOR_LIGHTGREEN) ;
-		PutStringAt(20, y, "   Temp (degrees C): %5.1f", plot.fltX100[plot.samples-1]/100.0) ;
-
-		DelayMS(50) ;
+		PipelineRun(&pipeline, AdcDmaWait()) ;
 		}
 
 	return 0 ;
 	}
 
-static BOOL UpdateData(PLOT_DATA *plot, int32_t degreesC)
+// Shows and plots each filtered temperature (degrees C times 100)
+static void PlotSink(PIPE_CHANNEL *channel, int32_t degreesC)
 	{
-	static int32_t oldMin = 0 ;
-	static int32_t oldMax = 0 ;
-	int32_t *pflt ;
-	int k ;
+	PLOT_DATA *plot = channel->spec->context ;
+	int32_t y ;
 
-	if (plot->samples > 0)
-		{
-		oldMin = plot->minX100 ;
-		oldMax = plot->maxX100 ;
-		}
+	SetForeground(COLOR_BLACK) ;
+	SetBackground(COLOR_LIGHTGREEN) ;
+	y = PutStringAt(20, plot->textY, "    Raw A/D Reading: %5d", (int) channel->raw) ;
 
-	if (plot->samples == ENTRIES(plot->rawX100))
+	if (UpdateData(plot, degreesC)) Rescale(plot) ;
+	else
 		{
-		memmove(&plot->rawX100[0], &plot->rawX100[1], sizeof(plot->rawX100) - sizeof(plot->rawX100[0])) ;
-		memmove(&plot->fltX100[0], &plot->fltX100[1], sizeof(plot->fltX100) - sizeof(plot->fltX100[0])) ;
-		plot->samples-- ;
+		StripScroll(&strip) ;
+		PlotDegreesC(plot) ;
 		}
+	StripBlit(&strip) ;
 
-	plot->rawX100[plot->samples] = degreesC ;
-	plot->fltX100[plot->samples] = LowPassFilter(plot, FILTER_SAMPLES) ;
-	plot->minX100 = plot->maxX100 = plot->fltX100[plot->samples++] ;
-
-	pflt = plot->fltX100 ;
-	for (k = 0; k < plot->samples; k++, pflt++)
-		{
-		if (*pflt < plot->minX100) plot->minX100 = *pflt ;
-		if (*pflt > plot->maxX100) plot->maxX100 = *pflt ;
-		}
+	SetForeground(COLOR_BLACK) ;
+	SetBackground(COLOR_LIGHTGREEN) ;
+	PutStringAt(20, y, "   Temp (degrees C): %5.1f", degreesC/100.0) ;
+	}
 
-	return plot->minX100 != oldMin || plot->maxX100 != oldMax ;
+static void VrefAlarm(int active)
+	{
+	LEDs(!active, active) ;
 	}
 
-static int32_t LowPassFilter(PLOT_DATA *plot, int depth)
+// Returns TRUE when the data no longer fits the scale on screen,
+// or fits in much less of it; small changes in min or max do not
+// cause a rescale.
+static BOOL UpdateData(PLOT_DATA *plot, int32_t degreesC)
 	{
-	int32_t total, *sample ;
-	int k ;
+	int32_t needed ;
 
-	if (depth > plot->samples + 1) depth = plot->samples + 1 ;
+	HistoryAppend(&plot->history, degreesC) ;
 
-	sample = &plot->rawX100[plot->samples] ;
-	total = 0 ; ;
-	for (k = 0; k < depth; k++)
-		{
-		total += *sample-- ;
-		}
+	// The window covers the same samples as the history
+	WindowPush(&plot->window, degreesC) ;
+	plot->minX100 = WindowMin(&plot->window) ;
+	plot->maxX100 = WindowMax(&plot->window) ;
 
-	return total / k ;
+	if (plot->maxC == plot->minC) return TRUE ;
+	if (plot->minX100 < 100*plot->minC || plot->maxX100 >= 100*plot->maxC) return TRUE ;
+
+	needed = (plot->maxX100 + 100)/100 - plot->minX100/100 ;
+	return (plot->maxC - plot->minC) > needed + 4*PLOT_PAD_C ;
 	}
 
 static void Rescale(PLOT_DATA *plot)
 	{
-	int degreesC, step, sample, line, range ;
-	char text[100] ;
-
-	// Erase all previous vertical labels
-	SetForeground(COLOR_WHITE) ;
-	FillRect(4, PLOT_YMIN - FONT.Height/2, 2*FONT.Width, PLOT_HEIGHT + FONT.Height/2) ;
-
-	// Paint background of graph
-	SetForeground(COLOR_LIGHTYELLOW) ;
-	FillRect(PLOT_XMIN, PLOT_YMIN, PLOT_WIDTH, PLOT_HEIGHT) ;
-
-	// Paint outline of graph
-	SetForeground(COLOR_BLACK) ;
-	DrawRect(PLOT_XMIN - 1, PLOT_YMIN - 1, PLOT_WIDTH + 1, PLOT_HEIGHT) ;
-
-	// Label vertical scale
-	plot->minC = plot->minX100/100 ;
-	plot->maxC = (plot->maxX100 + 100)/100 ;
-	if (plot->maxC == plot->minC) plot->maxC = plot->minC + 1 ;
+	int step, sample, samples, line, range, row ;
+	HISTORY *history = &plot->history ;
+	HISTORY_ITER iter ;
+	int32_t x100 ;
+
+	// Pad the scale so the data can wander a little before the next rescale
+	plot->minC = plot->minX100/100 - PLOT_PAD_C ;
+	plot->maxC = (plot->maxX100 + 100)/100 + PLOT_PAD_C ;
 	plot->yScale = (float) PLOT_HEIGHT / (plot->maxC - plot->minC) ;
 
-	step = 0.5 + (float) (plot->maxC - plot->minC + 1) / (PLOT_HEIGHT / FONT.Height) ;
-	if (step == 0) step = 1 ;
+	Labels(plot) ;
 
-	SetForeground(COLOR_BLACK) ;
-	SetBackground(COLOR_WHITE) ;
-	for (degreesC = plot->minC; degreesC <= plot->maxC; degreesC += step)
+	// Background of graph with horizontal grid lines; every
+	// column that scrolls into view is cleared to this
+	for (row = 0; row < PLOT_HEIGHT; row++)
 		{
-		int row = 0.5 + plot->yScale * (degreesC - plot->minC) ;
-		sprintf(text, "%d", (int) degreesC) ;
-		DisplayStringAt(4, PLOT_YMAX - row - FONT.Height/2, text) ;
+		StripBackground(&strip, row, COLOR_LIGHTYELLOW) ;
 		}
-
-	// Draw horizontal grid lines
 	range = plot->maxC - plot->minC ;
 	if (range == 1) step = 1 ;
 	else if (range <= 3) step = 2 ;
 	else step = 4 ;
-	SetForeground(COLOR_BLACK) ;
-	for (line = 0; line <= 4*range; line += step)
+	for (line = 0; line < 4*range; line += step)
 		{
-		int row = 0.5 + plot->yScale * line/4.0 ;
-		DrawHLine(PLOT_XMIN, PLOT_YMAX - row, PLOT_WIDTH) ;
+		row = 0.5 + plot->yScale * line/4.0 ;
+		StripBackground(&strip, PLOT_YMAX - row - PLOT_YMIN, COLOR_BLACK) ;
 		}
+	StripClear(&strip) ;
 
-	// Replot old data with new scale
-	for (sample = 0; sample < plot->samples; sample++)
+	// Row of every sample at the new scale, then replot; this is the
+	// only place rows[] is rewritten
+	samples = HistoryCount(history) ;
+	HistoryBegin(history, &iter) ;
+	for (sample = 0; HistoryNext(&iter, &x100); sample++)
 		{
-		PlotDegreesC(plot, sample) ;
+		plot->rows[HistorySlot(history, sample)] = Row(plot, x100) ;
 		}
+	for (sample = 1; sample < samples; sample++)
+		{
+		PlotSegment(sample, samples, plot->rows[HistorySlot(history, sample-1)], plot->rows[HistorySlot(history, sample)]) ;
+		}
+	}
+
+// Height in pixels above the bottom of the plot for a reading at the
+// current scale; the one place a row is worked out, so a replot matches
+// what was drawn
+static int Row(const PLOT_DATA *plot, int32_t x100)
+	{
+	return (plot->yScale / 100) * x100 - plot->yScale * plot->minC ;
 	}
 
-static void ShiftPlotLeft(void)
+// Redraws only the labels that moved or changed
+static void Labels(PLOT_DATA *plot)
 	{
-	uint32_t *px ;
-	int row ;
+	int16_t newC[PLOT_LABELS], newY[PLOT_LABELS] ;
+	int labels, degreesC, step, k, j, keep ;
+	char text[100] ;
+
+	step = 0.5 + (float) (plot->maxC - plot->minC + 1) / (PLOT_HEIGHT / FONT.Height) ;
+	if (step == 0) step = 1 ;
 
-	px = PixelAddress(PLOT_XMIN + 1, PLOT_YMIN) ;
-	for (row = PLOT_YMIN; row <= PLOT_YMAX; row++, px += 240)
+	labels = 0 ;
+	for (degreesC = plot->minC; degreesC <= plot->maxC && labels < PLOT_LABELS; degreesC += step)
 		{
-		memmove(px, px + 1, (PLOT_XMAX - PLOT_XMIN - 1)*sizeof(uint32_t)) ;
+		int row = 0.5 + plot->yScale * (degreesC - plot->minC) ;
+		newC[labels] = degreesC ;
+		newY[labels++] = PLOT_YMAX - row - FONT.Height/2 ;
 		}
+
+	// Erase old labels that are not in the new set
+	SetForeground(COLOR_WHITE) ;
+	for (k = 0; k < plot->labels; k++)
+		{
+		for (j = 0; j < labels; j++)
+			{
+			if (newC[j] == plot->labelC[k] && newY[j] == plot->labelY[k]) break ;
+			}
+		if (j < labels) continue ;
+		FillRect(4, plot->labelY[k], 2*FONT.Width, FONT.Height) ;
+		}
+
+	// Draw new labels, and kept ones an erase may have clipped
+	SetForeground(COLOR_BLACK) ;
+	SetBackground(COLOR_WHITE) ;
+	for (j = 0; j < labels; j++)
+		{
+		keep = 0 ;
+		for (k = 0; k < plot->labels; k++)
+			{
+			if (newC[j] == plot->labelC[k] && newY[j] == plot->labelY[k]) keep = 1 ;
+			else if (abs(newY[j] - plot->labelY[k]) < FONT.Height)
+				{
+				keep = 0 ;
+				break ;
+				}
+			}
+		if (keep) continue ;
+		sprintf(text, "%d", (int) newC[j]) ;
+		DisplayStringAt(4, newY[j], text) ;
+		}
+
+	plot->labels = labels ;
+	memcpy(plot->labelC, newC, sizeof(newC)) ;
+	memcpy(plot->labelY, newY, sizeof(newY)) ;
 	}
 
-static void PlotDegreesC(PLOT_DATA *plot, int sample)
+// Adds the newest sample, continuing from the row cached for the one
+// before; rows[] shares the history's ring, so nothing moves
+static void PlotDegreesC(PLOT_DATA *plot)
 	{
-	int yold, xnew, ynew ;
+	HISTORY *history = &plot->history ;
+	int samples, ynew ;
 
-	if (sample == 0 || plot->samples < 2) return ;
+	samples = HistoryCount(history) ;
+	ynew = Row(plot, HistoryAt(history, samples - 1)) ;
+	plot->rows[HistorySlot(history, samples - 1)] = ynew ;
+	if (samples >= 2) PlotSegment(samples - 1, samples, plot->rows[HistorySlot(history, samples - 2)], ynew) ;
+	}
 
-	yold = plot->yScale * (plot->fltX100[sample-1]/100.0 - plot->minC) ;
-	xnew = PLOT_XMAX - (plot->samples - sample) ;
-	ynew = plot->yScale * (plot->fltX100[sample]/100.0 - plot->minC) ;
+static void PlotSegment(int sample, int samples, int yold, int ynew)
+	{
+	int xnew = PLOT_XMAX - (samples - sample) ;
 
-	SetForeground(COLOR_RED) ;
-	DrawLine(xnew - 1, PLOT_YMAX - yold, xnew, PLOT_YMAX - ynew) ;
+	StripLine(&strip, xnew - 1 - PLOT_XMIN, PLOT_YMAX - yold - PLOT_YMIN, xnew - PLOT_XMIN, PLOT_YMAX - ynew - PLOT_YMIN, COLOR_RED) ;
 	}
 
 static void ADC_Init(void)
@@ -403,7 +499,8 @@ static BOOL SanityChecksOK(void)
 		{1,	 5,	 3,	 0,	 2},	{1,	-5,	 3,	 0,	-2},	{1,	 5,	-3,	 0,	-2},	{1,	-5,	-3,	0,  2},
 		{1,	 4,	 3,	 0,	 1},	{1,	-4,	 3,	 0,	-1},	{1,	 4,	-3,	 0,	-1},	{1,	-4,	-3,	0,  1}
 		} ;
-	int which, errors ;
+	int which, errors, mismatches ;
+	int32_t first[6] ;
 	CHECK *p ;
 
 	errors = 0 ;
@@ -413,10 +510,23 @@ static BOOL SanityChecksOK(void)
 		p->result = MxPlusB(p->x, p->mtop, p->mbtm, p->b) ;
 		if (p->result != p->correct) errors++ ;
 		}
-	LEDs(!errors, errors) ;
-	if (errors == 0) return TRUE ;
+	mismatches = (errors == 0) ? ScaleMismatches(first) : 0 ;
+	LEDs(!(errors || mismatches), errors || mismatches) ;
+	if (errors == 0 && mismatches == 0) return TRUE ;
 
 	printf("\n       SANITY CHECK ERRORS:\n\n") ;
+	if (mismatches != 0)
+		{
+		printf("       ScaleSamples != MxPlusB\n") ;
+		printf("       in %d cases, first:\n\n", mismatches) ;
+		printf("       x    = %ld\n", (long) first[0]) ;
+		printf("       mtop = %ld\n", (long) first[1]) ;
+		printf("       mbtm = %ld\n", (long) first[2]) ;
+		printf("       b    = %ld\n", (long) first[3]) ;
+		printf("       %ld != %ld\n", (long) first[5], (long) first[4]) ;
+		return FALSE ;
+		}
+
 	printf("       x mtop mbtm b  result\n") ;
 	printf("       - ---- ---- -  ------\n") ;
 
@@ -428,6 +538,58 @@ static BOOL SanityChecksOK(void)
 	return FALSE ;
 	}
 
+// Compares ScaleSamples with MxPlusB over every combination of the
+// values below, chosen around rounding ties, sign changes and the
+// points where x*mtop wraps. first[] gets x, mtop, mbtm, b, MxPlusB
+// and ScaleSamples for the first mismatch.
+static int ScaleMismatches(int32_t first[6])
+	{
+	static const int32_t xs[] =
+		{
+		0, 1, -1, 2, -2, 3, -3, 5, -5, 46340, 46341, -46341, 65535,
+		INT32_MAX, INT32_MIN, INT32_MAX - 1, INT32_MIN + 1, 0x40000000, -0x40000000
+		} ;
+	static const int32_t mtops[] =
+		{
+		0, 1, -1, 3, -3, 4, -5, 8000, -8000, 46341, 65536, INT32_MAX, INT32_MIN
+		} ;
+	static const int32_t mbtms[] =	// Not 0: SDIV could trap
+		{
+		1, -1, 2, -2, 3, -3, 7, -7, 12345, 0x7FFF, 0x10000, 0x10001,
+		INT32_MAX, INT32_MIN, INT32_MAX - 1, INT32_MIN + 1
+		} ;
+	static const int32_t bs[] = {0, 3000, -7, INT32_MAX, INT32_MIN} ;
+	int32_t results[COUNT(xs)], expect ;
+	int t, m, b, k, mismatches ;
+	SCALE scale ;
+
+	mismatches = 0 ;
+	for (t = 0; t < COUNT(mtops); t++)
+		{
+		for (m = 0; m < COUNT(mbtms); m++)
+			{
+			for (b = 0; b < COUNT(bs); b++)
+				{
+				ScaleInit(&scale, mtops[t], mbtms[m], bs[b]) ;
+				ScaleSamples(&scale, results, xs, COUNT(xs)) ;
+				for (k = 0; k < COUNT(xs); k++)
+					{
+					expect = MxPlusB(xs[k], mtops[t], mbtms[m], bs[b]) ;
+					if (results[k] == expect) continue ;
+					if (mismatches++ != 0) continue ;
+					first[0] = xs[k] ;
+					first[1] = mtops[t] ;
+					first[2] = mbtms[m] ;
+					first[3] = bs[b] ;
+					first[4] = expect ;
+					first[5] = results[k] ;
+					}
+				}
+			}
+		}
+	return mismatches ;
+	}
+
 static void LEDs(int grn_on, int red_on)
 	{
 	static uint32_t * const pGPIOG_MODER	= (uint32_t *) 0x40021800 ;
@@ -0,0 +1,298 @@
+/*
+	Continuous ADC1 acquisition on DMA2 stream 0.
+
+	ADC1 runs in scan and continuous mode with DDS set, so it asks for
+	a DMA transfer after every conversion for as long as it runs. The
+	stream is circular over both halves of the buffer: NDTR reloads at
+	the end and the interrupt fires at the half and at the end. Each
+	interrupt only counts the block; the consumer works out which half
+	it is from the count, so nothing is copied.
+
+	The temperature sensor needs at least 10 us to sample. With ADCCLK
+	at 84 MHz / 8 and 480 cycles of sampling, a conversion takes about
+	47 us and a scan of IN17 and IN18 about 94 us.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include "adcdma.h"
+
+#ifndef __arm__
+#include <time.h>
+#include <pthread.h>
+#endif
+
+static void				BlockDone(void) ;
+static const uint16_t *	Take(uint32_t filled) ;
+
+static uint16_t			buffer[2 * ADC_BLOCK_SCANS * ADC_MAX_CHANNELS] ;	// Halves of channelCount scans
+static uint32_t			channelCount ;
+static volatile uint32_t filled ;		// Blocks completed since the start
+static uint32_t			taken ;			// Blocks handed to the consumer
+static uint32_t			overruns ;
+
+const uint16_t *AdcDmaNext(void)
+	{
+	return Take(filled) ;
+	}
+
+uint32_t AdcDmaOverruns(void)
+	{
+	return overruns ;
+	}
+
+// Hands out the oldest block that is still intact
+static const uint16_t *Take(uint32_t done)
+	{
+	if (done == taken) return NULL ;
+
+	// Block n shares a half with block n + 2
+	if (done - taken > 1)
+		{
+		overruns += done - taken - 1 ;
+		taken = done - 1 ;
+		}
+	return buffer + (taken++ & 1) * ADC_BLOCK_SCANS * channelCount ;
+	}
+
+#ifdef __arm__
+
+typedef struct
+	{
+	uint32_t			SR ;		// Status register
+	uint32_t			CR[2] ;		// Control registers 1 & 2
+	uint32_t			SMPR[2] ;	// Sample time registers 1,2
+	uint32_t			JOFR[4] ;	// Injected channel data offset registers 1-4
+	uint32_t			HTR ;		// Watchdog higher threshold register
+	uint32_t			LTR ;		// Watchdog lower threshold register
+	uint32_t			SQR[3] ;	// Regular sequence register 1-3
+	uint32_t			JSQR ;		// Injected sequence register
+	uint32_t			JDR[4] ;	// Injected data registers 1-4
+	uint32_t			DR ;		// Regular data register
+	} ADC_REGS ;
+
+typedef struct
+	{
+	uint32_t			CR ;		// Configuration register
+	uint32_t			NDTR ;		// Number of data items register
+	const void *		PAR ;		// Peripheral (source) address register
+	void *				M0AR ;		// Memory 0 (destination) address register
+	void *				M1AR ;		// Memory 1 address register
+	uint32_t			FCR ;		// FIFO control register
+	} DMA_STREAM ;
+
+static		uint32_t	const SCAN			= (1 <<  8) ;	// ADC CR1: convert every channel in SQR
+static		uint32_t	const ADON			= (1 <<  0) ;	// ADC CR2: on
+static		uint32_t	const CONT			= (1 <<  1) ;	// ADC CR2: start again after each scan
+static		uint32_t	const DMA			= (1 <<  8) ;	// ADC CR2: request DMA for each result
+static		uint32_t	const DDS			= (1 <<  9) ;	// ADC CR2: keep requesting after NDTR reloads
+static		uint32_t	const SWSTART		= (1 << 30) ;	// ADC CR2: start
+static		uint32_t	const OVR			= (1 <<  5) ;	// ADC SR: overrun
+static		uint32_t	const SMP_480		= 7 ;			// 480 cycle sample time
+static		uint32_t	const ADCPRE_8		= (3 << 16) ;	// ADCCLK = PCLK2 / 8
+static		uint32_t	const TSVREFE		= (1 << 23) ;	// Enable temp sensor & Vref
+static		uint32_t	const MSIZE			= (1 << 13) ;	// Write 16-bit halfwords
+static		uint32_t	const PSIZE			= (1 << 11) ;	// Read 16-bit halfwords
+static		uint32_t	const MINC			= (1 << 10) ;	// Autoincr dst adrs
+static		uint32_t	const CIRC			= (1 <<  8) ;	// Reload NDTR & M0AR at the end
+static		uint32_t	const TCIE			= (1 <<  4) ;	// Transfer complete interrupt enable
+static		uint32_t	const HTIE			= (1 <<  3) ;	// Half transfer interrupt enable
+static		uint32_t	const EN			= (1 <<  0) ;	// "Go"
+static		uint32_t	const TCIF0			= (1 <<  5) ;	// Transfer complete flag
+static		uint32_t	const HTIF0			= (1 <<  4) ;	// Half transfer flag
+static		uint32_t	const IRQ_BIT		= (1 << 24) ;	// DMA2_Stream0 is IRQ 56
+static volatile ADC_REGS *	const ADC1			= (ADC_REGS *)		0x40012000 ;
+static volatile uint32_t *	const pADC_CCR		= (uint32_t *)		0x40012304 ;
+static volatile uint32_t *	const pDMA2_LISR	= (uint32_t *)		0x40026400 ;
+static volatile uint32_t *	const pDMA2_LIFCR	= (uint32_t *)		0x40026408 ;
+static volatile DMA_STREAM *const DMA2_S0		= (DMA_STREAM *)	0x40026410 ;
+static volatile uint32_t *	const pRCC_AHB1ENR	= (uint32_t *)		0x40023830 ;
+static volatile uint32_t *	const pRCC_APB2ENR	= (uint32_t *)		0x40023844 ;
+static volatile uint32_t *	const pNVIC_ISER1	= (uint32_t *)		0xE000E104 ;
+static volatile uint32_t *	const pNVIC_ICER1	= (uint32_t *)		0xE000E184 ;
+
+void AdcDmaStart(const uint8_t channels[], uint32_t count)
+	{
+	uint32_t k, sqr[3] = {0} ;
+
+	AdcDmaStop() ;
+	if (count > ADC_MAX_CHANNELS) count = ADC_MAX_CHANNELS ;
+	channelCount = count ;
+	filled = taken = overruns = 0 ;
+
+	*pRCC_APB2ENR	|= (1 <<  8) ;			// Enable ADC1 clock
+	*pRCC_AHB1ENR	|= (1 << 22) ;			// Enable DMA2 clock
+	*pADC_CCR		= (*pADC_CCR & ~(3 << 16)) | ADCPRE_8 | TSVREFE ;
+
+	// Sequence: SQR3 holds entries 1-6, SQR1 the length
+	for (k = 0; k < count; k++)
+		{
+		sqr[2] |= channels[k] << (5*k) ;
+		if (channels[k] < 10) ADC1->SMPR[1] |= SMP_480 << (3*channels[k]) ;
+		else ADC1->SMPR[0] |= SMP_480 << (3*(channels[k] - 10)) ;
+		}
+	sqr[0] = (count - 1) << 20 ;
+	ADC1->SQR[0]	= sqr[0] ;
+	ADC1->SQR[1]	= sqr[1] ;
+	ADC1->SQR[2]	= sqr[2] ;
+
+	DMA2_S0->CR		= 0 ;					// Channel 0 is ADC1
+	while ((DMA2_S0->CR & EN) != 0) ;
+	DMA2_S0->PAR	= (const void *) &ADC1->DR ;
+	DMA2_S0->M0AR	= buffer ;
+	DMA2_S0->NDTR	= 2 * ADC_BLOCK_SCANS * count ;
+	DMA2_S0->FCR	= 0 ;					// Direct mode
+	*pDMA2_LIFCR	= TCIF0 | HTIF0 ;
+	DMA2_S0->CR		= MSIZE|PSIZE|MINC|CIRC|TCIE|HTIE|EN ;
+	*pNVIC_ISER1	= IRQ_BIT ;
+
+	ADC1->SR		&= ~OVR ;
+	ADC1->CR[0]		= SCAN ;
+	ADC1->CR[1]		= ADON|CONT|DMA|DDS ;
+	ADC1->CR[1]		|= SWSTART ;
+	}
+
+void AdcDmaStop(void)
+	{
+	ADC1->CR[1]		&= ~(CONT|DMA|DDS) ;
+	*pNVIC_ICER1	= IRQ_BIT ;
+	DMA2_S0->CR		= 0 ;
+	while ((DMA2_S0->CR & EN) != 0) ;
+	*pDMA2_LIFCR	= TCIF0 | HTIF0 ;
+	}
+
+const uint16_t *AdcDmaWait(void)
+	{
+	const uint16_t *block ;
+
+	while ((block = AdcDmaNext()) == NULL) ;
+	return block ;
+	}
+
+void DMA2_Stream0_IRQHandler(void)
+	{
+	uint32_t flags ;
+
+	flags = *pDMA2_LISR & (TCIF0 | HTIF0) ;
+	*pDMA2_LIFCR = flags ;
+	if ((flags & HTIF0) != 0) BlockDone() ;
+	if ((flags & TCIF0) != 0) BlockDone() ;
+	}
+
+static void BlockDone(void)
+	{
+	filled++ ;
+	}
+
+#else
+
+static void *			Simulate(void *arg) ;
+static uint16_t			Sensor(uint32_t channel, uint32_t scan) ;
+
+static pthread_mutex_t	mutex = PTHREAD_MUTEX_INITIALIZER ;
+static pthread_cond_t	ready = PTHREAD_COND_INITIALIZER ;	// filled changed
+static pthread_t		thread ;
+static uint8_t			simChannels[ADC_MAX_CHANNELS] ;
+static uint32_t			simRate = 10000 ;
+static volatile int		running ;
+
+void AdcSimRate(uint32_t scansPerSecond)
+	{
+	simRate = scansPerSecond ;
+	}
+
+void AdcDmaStart(const uint8_t channels[], uint32_t count)
+	{
+	uint32_t k ;
+
+	AdcDmaStop() ;
+	if (count > ADC_MAX_CHANNELS) count = ADC_MAX_CHANNELS ;
+	for (k = 0; k < count; k++) simChannels[k] = channels[k] ;
+	channelCount = count ;
+	filled = taken = overruns = 0 ;
+
+	running = 1 ;
+	pthread_create(&thread, NULL, Simulate, NULL) ;
+	}
+
+void AdcDmaStop(void)
+	{
+	if (!running) return ;
+	running = 0 ;
+	pthread_join(thread, NULL) ;
+	}
+
+const uint16_t *AdcDmaWait(void)
+	{
+	uint32_t done ;
+
+	pthread_mutex_lock(&mutex) ;
+	while ((done = filled) == taken && running) pthread_cond_wait(&ready, &mutex) ;
+	pthread_mutex_unlock(&mutex) ;
+	return Take(done) ;
+	}
+
+static void BlockDone(void)
+	{
+	pthread_mutex_lock(&mutex) ;
+	filled++ ;
+	pthread_cond_signal(&ready) ;
+	pthread_mutex_unlock(&mutex) ;
+	}
+
+// Plays the part of the ADC and DMA: fills each half in turn,
+// paced so the blocks arrive at simRate scans per second
+static void *Simulate(void *arg)
+	{
+	struct timespec due ;
+	uint32_t scan, k, half ;
+	uint16_t *p ;
+	uint64_t ns ;
+
+	(void) arg ;
+	clock_gettime(CLOCK_MONOTONIC, &due) ;
+	scan = 0 ;
+	for (half = 0; running; half ^= 1)
+		{
+		p = buffer + half * ADC_BLOCK_SCANS * channelCount ;
+		for (k = 0; k < ADC_BLOCK_SCANS; k++, scan++)
+			{
+			uint32_t c ;
+
+			for (c = 0; c < channelCount; c++) *p++ = Sensor(simChannels[c], scan) ;
+			}
+
+		if (simRate != 0)
+			{
+			ns = due.tv_nsec + (uint64_t) ADC_BLOCK_SCANS * 1000000000 / simRate ;
+			due.tv_sec += ns / 1000000000 ;
+			due.tv_nsec = ns % 1000000000 ;
+			clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL) ;
+			}
+		BlockDone() ;
+		}
+
+	// Wake a consumer waiting for a block that will not come
+	pthread_mutex_lock(&mutex) ;
+	pthread_cond_broadcast(&ready) ;
+	pthread_mutex_unlock(&mutex) ;
+	return NULL ;
+	}
+
+// Vref near its calibrated value; the temperature sensor drifting
+// slowly around 30 degrees C. Both get a few counts of noise.
+static uint16_t Sensor(uint32_t channel, uint32_t scan)
+	{
+	static uint32_t seed = 12345 ;
+	int32_t noise, drift ;
+
+	seed = 1664525 * seed + 1013904223 ;
+	noise = (int32_t) (seed >> 29) - 4 ;
+	if (channel == 17) return 1500 + noise ;
+
+	drift = (scan >> 10) & 63 ;
+	if (drift > 31) drift = 63 - drift ;
+	return 940 + drift + noise ;
+	}
+
+#endif
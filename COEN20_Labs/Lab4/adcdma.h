@@ -0,0 +1,37 @@
+/*
+	Continuous ADC1 acquisition into a double buffer.
+
+	ADC1 scans a list of channels (e.g. IN17, IN18) over and over and
+	DMA2 stream 0 (channel 0) writes the results into a circular buffer
+	of two halves. The half-transfer and transfer-complete interrupts
+	each mark one half, a block of ADC_BLOCK_SCANS scans, as ready while
+	the other half fills. A block holds the scans in order with the
+	channels of each scan interleaved in the order given to AdcDmaStart.
+
+	A block stays valid until the DMA comes back around to its half, so
+	it must be used within one block time. Blocks that were overwritten
+	before being taken are skipped and counted by AdcDmaOverruns.
+
+	A host build has no ADC; a thread produces the same blocks from a
+	simulated sensor at the rate set by AdcSimRate.
+*/
+
+#ifndef ADCDMA_H
+#define	ADCDMA_H
+
+#include <stdint.h>
+
+#define	ADC_MAX_CHANNELS	4
+#define	ADC_BLOCK_SCANS		512		// About 50 ms of scans of IN17 & IN18
+
+extern void				AdcDmaStart(const uint8_t channels[], uint32_t count) ;
+extern void				AdcDmaStop(void) ;
+extern const uint16_t *	AdcDmaNext(void) ;		// NULL if no block is ready
+extern const uint16_t *	AdcDmaWait(void) ;
+extern uint32_t			AdcDmaOverruns(void) ;
+
+#ifndef __arm__
+extern void				AdcSimRate(uint32_t scansPerSecond) ;	// 0 = as fast as possible
+#endif
+
+#endif
@@ -0,0 +1,67 @@
+/*
+	Piecewise-linear calibration.
+
+	Each segment keeps its own SCALE, so the division for its slope is
+	worked out once by CalibLoad. Finding the segment is a binary search
+	whose only branch is the loop itself: each step halves the range and
+	picks the upper half with a conditional select, so a lookup in a
+	16-point table always takes four steps.
+*/
+
+#include <stdint.h>
+#include "calib.h"
+
+static uint32_t			Segment(const CALIB *calib, int32_t raw) ;
+
+int CalibLoad(CALIB *calib, const CALIB_POINT points[], uint32_t count)
+	{
+	uint32_t k ;
+
+	if (count < 2 || count > CALIB_MAX_POINTS) return 0 ;
+	for (k = 1; k < count; k++)
+		{
+		if (points[k].raw <= points[k-1].raw) return 0 ;
+		}
+
+	calib->segments = count - 1 ;
+	for (k = 0; k < count - 1; k++)
+		{
+		calib->start[k] = points[k].raw ;
+		ScaleInit(&calib->scale[k], points[k+1].value - points[k].value,
+			points[k+1].raw - points[k].raw, points[k].value) ;
+		}
+	return 1 ;
+	}
+
+int32_t CalibOne(const CALIB *calib, int32_t raw)
+	{
+	uint32_t k = Segment(calib, raw) ;
+	return ScaleOne(&calib->scale[k], raw - calib->start[k]) ;
+	}
+
+void CalibSamples(const CALIB *calib, int32_t dst[], const int32_t src[], uint32_t count)
+	{
+	uint32_t k ;
+	int32_t raw ;
+
+	while (count-- != 0)
+		{
+		raw = *src++ ;
+		k = Segment(calib, raw) ;
+		*dst++ = ScaleOne(&calib->scale[k], raw - calib->start[k]) ;
+		}
+	}
+
+// Last segment starting at or below raw (the first if none does)
+static uint32_t Segment(const CALIB *calib, int32_t raw)
+	{
+	uint32_t base = 0, n = calib->segments, half ;
+
+	while (n > 1)
+		{
+		half = n / 2 ;
+		base = (calib->start[base + half] <= raw) ? base + half : base ;
+		n -= half ;
+		}
+	return base ;
+	}
@@ -0,0 +1,35 @@
+/*
+	Piecewise-linear calibration: converts raw readings to values using
+	a table of 2 to CALIB_MAX_POINTS (raw, value) points with raw
+	strictly ascending. Readings between two points are interpolated
+	along their segment with the same rounding as MxPlusB; readings
+	outside the table extend the first or last segment.
+*/
+
+#ifndef CALIB_H
+#define	CALIB_H
+
+#include <stdint.h>
+#include "scale.h"
+
+#define	CALIB_MAX_POINTS	16
+
+typedef struct
+	{
+	int32_t				raw ;
+	int32_t				value ;
+	} CALIB_POINT ;
+
+typedef struct
+	{
+	uint32_t			segments ;
+	int32_t				start[CALIB_MAX_POINTS - 1] ;	// raw at the start of each segment
+	SCALE				scale[CALIB_MAX_POINTS - 1] ;	// value = scale(raw - start)
+	} CALIB ;
+
+// Returns 0 (and leaves calib unchanged) if the table is unusable
+extern int				CalibLoad(CALIB *calib, const CALIB_POINT points[], uint32_t count) ;
+extern int32_t			CalibOne(const CALIB *calib, int32_t raw) ;
+extern void				CalibSamples(const CALIB *calib, int32_t dst[], const int32_t src[], uint32_t count) ;
+
+#endif
@@ -0,0 +1,209 @@
+/*
+	Streaming filters.
+
+	The moving average adds the new sample and subtracts the one that
+	falls out of the ring, then divides by the number of samples, the
+	same result as re-summing them. The median sorts a copy of the ring,
+	at most FILTER_MAX_DEPTH entries.
+
+	Each WINDOW deque holds only samples that could still become the
+	minimum (or maximum): a new sample removes every older one it beats
+	from the tail, and the head is dropped once it leaves the window.
+	Every sample is added and removed at most once. The head is dropped
+	before the new sample goes in, so a deque never holds more than size
+	entries and a window of WINDOW_CAPACITY fits.
+*/
+
+#include <stdint.h>
+#include "filter.h"
+
+#ifdef FILTER_TEST
+#include <stdio.h>
+#include <stdlib.h>
+#endif
+
+#define	MASK				(WINDOW_CAPACITY - 1)
+
+static int32_t			Median(const FILTER *filter) ;
+static void				Expire(WINDOW_DEQUE *deque, uint32_t index, uint32_t size) ;
+static void				Push(WINDOW_DEQUE *deque, uint32_t index, int32_t value, int max) ;
+
+void FilterInit(FILTER *filter, FILTER_KIND kind, uint32_t param)
+	{
+	if (kind != FILTER_EMA)
+		{
+		if (param < 1) param = 1 ;
+		if (param > FILTER_MAX_DEPTH) param = FILTER_MAX_DEPTH ;
+		}
+	else if (param > 15) param = 15 ;
+
+	filter->kind	= kind ;
+	filter->param	= param ;
+	filter->count	= 0 ;
+	filter->next	= 0 ;
+	filter->total	= 0 ;
+	}
+
+int32_t FilterNext(FILTER *filter, int32_t sample)
+	{
+	uint32_t shift ;
+
+	if (filter->kind == FILTER_EMA)
+		{
+		shift = filter->param ;
+		if (filter->count++ == 0) filter->total = sample * (1 << shift) ;
+		else filter->total += sample - (filter->total >> shift) ;
+		return (filter->total + ((1 << shift) >> 1)) >> shift ;
+		}
+
+	if (filter->count < filter->param) filter->count++ ;
+	else filter->total -= filter->ring[filter->next] ;
+
+	filter->ring[filter->next] = sample ;
+	filter->total += sample ;
+	if (++filter->next == filter->param) filter->next = 0 ;
+
+	if (filter->kind == FILTER_MEDIAN) return Median(filter) ;
+	return filter->total / (int32_t) filter->count ;
+	}
+
+static int32_t Median(const FILTER *filter)
+	{
+	int32_t sorted[FILTER_MAX_DEPTH], value ;
+	uint32_t k, j, n = filter->count ;
+
+	// Insertion sort; ring order does not matter
+	for (k = 0; k < n; k++)
+		{
+		value = filter->ring[k] ;
+		for (j = k; j > 0 && sorted[j-1] > value; j--) sorted[j] = sorted[j-1] ;
+		sorted[j] = value ;
+		}
+
+	if (n & 1) return sorted[n/2] ;
+	return (sorted[n/2 - 1] + sorted[n/2]) / 2 ;
+	}
+
+void WindowInit(WINDOW *window, uint32_t size)
+	{
+	if (size < 1) size = 1 ;
+	if (size > WINDOW_CAPACITY) size = WINDOW_CAPACITY ;
+
+	window->size = size ;
+	window->seen = 0 ;
+	window->min.head = window->min.tail = 0 ;
+	window->max.head = window->max.tail = 0 ;
+	}
+
+void WindowPush(WINDOW *window, int32_t value)
+	{
+	uint32_t index = window->seen++ ;
+
+	Expire(&window->min, index, window->size) ;
+	Expire(&window->max, index, window->size) ;
+	Push(&window->min, index, value, 0) ;
+	Push(&window->max, index, value, 1) ;
+	}
+
+int32_t WindowMin(const WINDOW *window)
+	{
+	if (window->seen == 0) return 0 ;
+	return window->min.entry[window->min.head & MASK].value ;
+	}
+
+int32_t WindowMax(const WINDOW *window)
+	{
+	if (window->seen == 0) return 0 ;
+	return window->max.entry[window->max.head & MASK].value ;
+	}
+
+// Drop the oldest candidate if sample index pushes it out of the window;
+// indices are consecutive, so at most one goes
+static void Expire(WINDOW_DEQUE *deque, uint32_t index, uint32_t size)
+	{
+	if (deque->head == deque->tail) return ;
+	if (deque->entry[deque->head & MASK].index + size <= index) deque->head++ ;
+	}
+
+static void Push(WINDOW_DEQUE *deque, uint32_t index, int32_t value, int max)
+	{
+	WINDOW_ENTRY *back ;
+
+	while (deque->tail != deque->head)
+		{
+		back = &deque->entry[(deque->tail - 1) & MASK] ;
+		if (max ? (back->value > value) : (back->value < value)) break ;
+		deque->tail-- ;
+		}
+
+	deque->entry[deque->tail & MASK].index = index ;
+	deque->entry[deque->tail & MASK].value = value ;
+	deque->tail++ ;
+	}
+
+#ifdef FILTER_TEST
+
+#define	SAMPLES			100000
+
+static int				Check(uint32_t size, int pattern) ;
+static int32_t			Sample(uint32_t k, int pattern) ;
+
+static int32_t			stream[SAMPLES] ;
+
+// Every window size from 1 to WINDOW_CAPACITY against a brute-force scan,
+// over random samples and ramps that keep every sample a candidate
+int main(void)
+	{
+	uint32_t size ;
+	int pattern, errors = 0 ;
+
+	for (pattern = 0; pattern < 4; pattern++)
+		{
+		for (size = 1; size <= WINDOW_CAPACITY; size++)
+			{
+			errors += Check(size, pattern) ;
+			}
+		}
+	printf("%d wrong results\n", errors) ;
+	return errors != 0 ;
+	}
+
+static int Check(uint32_t size, int pattern)
+	{
+	static WINDOW window ;
+	uint32_t k, j, first, samples ;
+	int32_t lo, hi ;
+	int errors = 0 ;
+
+	samples = (size == 1 || size >= WINDOW_CAPACITY - 1) ? SAMPLES : 4 * WINDOW_CAPACITY ;
+	WindowInit(&window, size) ;
+	for (k = 0; k < samples; k++)
+		{
+		stream[k] = Sample(k, pattern) ;
+		WindowPush(&window, stream[k]) ;
+
+		first = (k + 1 > size) ? k + 1 - size : 0 ;
+		lo = hi = stream[first] ;
+		for (j = first + 1; j <= k; j++)
+			{
+			if (stream[j] < lo) lo = stream[j] ;
+			if (stream[j] > hi) hi = stream[j] ;
+			}
+		if (WindowMin(&window) != lo || WindowMax(&window) != hi) errors++ ;
+		}
+	if (errors != 0) printf("size %u, pattern %d: %d wrong\n", (unsigned) size, pattern, errors) ;
+	return errors ;
+	}
+
+static int32_t Sample(uint32_t k, int pattern)
+	{
+	switch (pattern)
+		{
+		case 0:  return rand() % 4096 ;
+		case 1:  return (int32_t) k ;				// Every sample stays in the min deque
+		case 2:  return -(int32_t) k ;				// ... and in the max deque
+		default: return (k / 300) & 1 ? (int32_t) k : -(int32_t) k ;
+		}
+	}
+
+#endif
@@ -0,0 +1,72 @@
+/*
+	Streaming filters for one sample at a time.
+
+	FILTER smooths a stream: a moving average over the last depth
+	samples (a running sum, so O(1) per sample), an exponential moving
+	average with weight 1/2^shift, or the median of the last depth
+	samples. Until depth samples have arrived the average and median
+	use as many as there are.
+
+	WINDOW tracks the minimum and maximum of the last size samples
+	(up to WINDOW_CAPACITY) with two monotonic deques, in O(1) amortized
+	time per sample. A host build with FILTER_TEST defined checks every
+	window size against a brute-force scan:
+
+		gcc -O2 -DFILTER_TEST -o filter filter.c && ./filter
+*/
+
+#ifndef FILTER_H
+#define	FILTER_H
+
+#include <stdint.h>
+
+#define	FILTER_MAX_DEPTH	16
+#define	WINDOW_CAPACITY		256		// Largest window; a power of two
+
+typedef enum
+	{
+	FILTER_AVERAGE,		// param = depth
+	FILTER_EMA,			// param = shift
+	FILTER_MEDIAN		// param = depth
+	} FILTER_KIND ;
+
+typedef struct
+	{
+	FILTER_KIND			kind ;
+	uint32_t			param ;
+	uint32_t			count ;		// Samples in ring (up to depth)
+	uint32_t			next ;		// Where the next sample goes
+	int32_t				total ;		// Running sum, or EMA scaled by 2^shift
+	int32_t				ring[FILTER_MAX_DEPTH] ;
+	} FILTER ;
+
+typedef struct
+	{
+	uint32_t			index ;		// Position in the stream
+	int32_t				value ;
+	} WINDOW_ENTRY ;
+
+typedef struct
+	{
+	uint32_t			head ;		// Free-running; masked to index entry[]
+	uint32_t			tail ;
+	WINDOW_ENTRY		entry[WINDOW_CAPACITY] ;
+	} WINDOW_DEQUE ;
+
+typedef struct
+	{
+	uint32_t			size ;
+	uint32_t			seen ;		// Samples pushed so far
+	WINDOW_DEQUE		min ;		// Values ascending from head
+	WINDOW_DEQUE		max ;		// Values descending from head
+	} WINDOW ;
+
+extern void				FilterInit(FILTER *filter, FILTER_KIND kind, uint32_t param) ;
+extern int32_t			FilterNext(FILTER *filter, int32_t sample) ;
+
+extern void				WindowInit(WINDOW *window, uint32_t size) ;
+extern void				WindowPush(WINDOW *window, int32_t value) ;
+extern int32_t			WindowMin(const WINDOW *window) ;
+extern int32_t			WindowMax(const WINDOW *window) ;
+
+#endif
@@ -0,0 +1,59 @@
+/*
+	Sample history in a ring buffer.
+
+	head counts every sample ever appended; masking it with
+	HISTORY_SIZE - 1 gives the slot, and the oldest sample is count
+	slots behind it. The counter can wrap around without harm because
+	HISTORY_SIZE divides 2^32.
+*/
+
+#include <stdint.h>
+#include "history.h"
+
+#define	MASK				(HISTORY_SIZE - 1)
+
+void HistoryInit(HISTORY *history, uint32_t limit)
+	{
+	if (limit < 1) limit = 1 ;
+	if (limit > HISTORY_SIZE) limit = HISTORY_SIZE ;
+
+	history->head = 0 ;
+	history->count = 0 ;
+	history->limit = limit ;
+	}
+
+void HistoryAppend(HISTORY *history, int32_t sample)
+	{
+	history->data[history->head++ & MASK] = sample ;
+	if (history->count < history->limit) history->count++ ;
+	}
+
+uint32_t HistoryCount(const HISTORY *history)
+	{
+	return history->count ;
+	}
+
+int32_t HistoryAt(const HISTORY *history, uint32_t which)
+	{
+	return history->data[HistorySlot(history, which)] ;
+	}
+
+uint32_t HistorySlot(const HISTORY *history, uint32_t which)
+	{
+	return (history->head - history->count + which) & MASK ;
+	}
+
+void HistoryBegin(const HISTORY *history, HISTORY_ITER *iter)
+	{
+	iter->history = history ;
+	iter->next = history->head - history->count ;
+	iter->left = history->count ;
+	}
+
+int HistoryNext(HISTORY_ITER *iter, int32_t *sample)
+	{
+	if (iter->left == 0) return 0 ;
+	iter->left-- ;
+	*sample = iter->history->data[iter->next++ & MASK] ;
+	return 1 ;
+	}
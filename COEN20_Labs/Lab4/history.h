@@ -0,0 +1,42 @@
+/*
+	Sample history: the most recent samples (up to a limit of at most
+	HISTORY_SIZE) in a power-of-two ring buffer. Appending overwrites
+	the oldest sample once the limit is reached, so nothing is moved.
+	Samples are numbered from 0 (oldest) to HistoryCount - 1 (newest),
+	and an iterator walks them in that order. HistorySlot gives where a
+	sample is kept, so a HISTORY_SIZE array indexed the same way can
+	hold something derived from each sample without moving either.
+*/
+
+#ifndef HISTORY_H
+#define	HISTORY_H
+
+#include <stdint.h>
+
+#define	HISTORY_SIZE		256		// A power of two
+
+typedef struct
+	{
+	uint32_t			head ;		// Free-running; the next sample goes at head & mask
+	uint32_t			count ;
+	uint32_t			limit ;
+	int32_t				data[HISTORY_SIZE] ;
+	} HISTORY ;
+
+typedef struct
+	{
+	const HISTORY *		history ;
+	uint32_t			next ;		// Free-running position of the next sample
+	uint32_t			left ;
+	} HISTORY_ITER ;
+
+extern void				HistoryInit(HISTORY *history, uint32_t limit) ;
+extern void				HistoryAppend(HISTORY *history, int32_t sample) ;
+extern uint32_t			HistoryCount(const HISTORY *history) ;
+extern int32_t			HistoryAt(const HISTORY *history, uint32_t which) ;
+extern uint32_t			HistorySlot(const HISTORY *history, uint32_t which) ;	// 0 .. HISTORY_SIZE - 1
+
+extern void				HistoryBegin(const HISTORY *history, HISTORY_ITER *iter) ;
+extern int				HistoryNext(HISTORY_ITER *iter, int32_t *sample) ;
+
+#endif
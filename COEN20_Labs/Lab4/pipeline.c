@@ -0,0 +1,170 @@
+/*
+	Multi-channel sensor pipeline.
+
+	The channels of a scan are interleaved in each block. A channel's
+	samples are first gathered into a contiguous work array, so that
+	CalibSamples runs over the whole block in one call; the work arrays
+	are shared, as channels are processed one after another.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include "pipeline.h"
+
+#ifdef PIPELINE_BENCH
+#include <time.h>
+#endif
+
+static void				RunChannel(PIPE_CHANNEL *channel, const uint16_t block[], uint32_t column, uint32_t stride) ;
+
+static int32_t			raw[ADC_BLOCK_SCANS] ;
+static int32_t			value[ADC_BLOCK_SCANS] ;
+
+int PipelineInit(PIPELINE *pipeline, const PIPE_SPEC specs[], uint32_t count)
+	{
+	PIPE_CHANNEL *channel ;
+	uint32_t k ;
+
+	if (count == 0 || count > ADC_MAX_CHANNELS) return 0 ;
+
+	pipeline->count = count ;
+	for (k = 0; k < count; k++)
+		{
+		channel = &pipeline->channel[k] ;
+		channel->spec		= &specs[k] ;
+		channel->count		= 0 ;
+		channel->total		= 0 ;
+		channel->rawTotal	= 0 ;
+		channel->raw		= 0 ;
+		if (specs[k].decimate == 0) return 0 ;
+		if (!CalibLoad(&channel->calib, specs[k].points, specs[k].pointCount)) return 0 ;
+		FilterInit(&channel->filter, specs[k].filter, specs[k].param) ;
+		}
+	return 1 ;
+	}
+
+void PipelineStart(const PIPELINE *pipeline)
+	{
+	uint8_t inputs[ADC_MAX_CHANNELS] ;
+	uint32_t k ;
+
+	for (k = 0; k < pipeline->count; k++)
+		{
+		inputs[k] = pipeline->channel[k].spec->input ;
+		}
+	AdcDmaStart(inputs, pipeline->count) ;
+	}
+
+void PipelineRun(PIPELINE *pipeline, const uint16_t block[])
+	{
+	uint32_t k ;
+
+	for (k = 0; k < pipeline->count; k++)
+		{
+		RunChannel(&pipeline->channel[k], block, k, pipeline->count) ;
+		}
+	}
+
+void SinkLog(PIPE_CHANNEL *channel, int32_t value)
+	{
+	printf("%s: %ld (raw %ld)\n", channel->spec->name, (long) value, (long) channel->raw) ;
+	}
+
+void SinkAlarm(PIPE_CHANNEL *channel, int32_t value)
+	{
+	PIPE_ALARM *alarm = channel->spec->context ;
+	int active ;
+
+	if (alarm->active)
+		{
+		active = value < alarm->low + alarm->hysteresis || value > alarm->high - alarm->hysteresis ;
+		}
+	else active = value < alarm->low || value > alarm->high ;
+
+	if (active == alarm->active) return ;
+	alarm->active = active ;
+	if (alarm->notify != NULL) (*alarm->notify)(active) ;
+	}
+
+static void RunChannel(PIPE_CHANNEL *channel, const uint16_t block[], uint32_t column, uint32_t stride)
+	{
+	const PIPE_SPEC *spec = channel->spec ;
+	uint32_t k ;
+	int32_t flt ;
+
+	block += column ;
+	for (k = 0; k < ADC_BLOCK_SCANS; k++, block += stride)
+		{
+		raw[k] = *block ;
+		}
+	CalibSamples(&channel->calib, value, raw, ADC_BLOCK_SCANS) ;
+
+	for (k = 0; k < ADC_BLOCK_SCANS; k++)
+		{
+		channel->total += value[k] ;
+		channel->rawTotal += raw[k] ;
+		if (++channel->count < spec->decimate) continue ;
+
+		channel->raw = channel->rawTotal / spec->decimate ;
+		flt = FilterNext(&channel->filter, channel->total / spec->decimate) ;
+		channel->count = 0 ;
+		channel->total = 0 ;
+		channel->rawTotal = 0 ;
+		(*spec->sink)(channel, flt) ;
+		}
+	}
+
+#ifdef PIPELINE_BENCH
+
+static void				Count(PIPE_CHANNEL *channel, int32_t value) ;
+
+static uint32_t			outputs ;
+
+static void Count(PIPE_CHANNEL *channel, int32_t value)
+	{
+	(void) channel ;
+	(void) value ;
+	outputs++ ;
+	}
+
+// Runs 1 to ADC_MAX_CHANNELS copies of the Lab 4 temperature channel
+// against the simulated ADC, unpaced, and reports how many samples per
+// second the pipeline processes
+int main(void)
+	{
+	static const CALIB_POINT points[] = {{940, 3000}, {1200, 11000}} ;
+	static const PIPE_SPEC temp =
+		{"Temp", 18, points, 2, FILTER_AVERAGE, 5, ADC_BLOCK_SCANS, Count, NULL} ;
+	static PIPE_SPEC specs[ADC_MAX_CHANNELS] ;
+	static PIPELINE pipeline ;
+	struct timespec start, now ;
+	uint32_t channels, k, blocks ;
+	double seconds ;
+
+	AdcSimRate(0) ;
+	printf("channels,blocks,overruns,samples/s,ns/sample\n") ;
+	for (channels = 1; channels <= ADC_MAX_CHANNELS; channels++)
+		{
+		for (k = 0; k < channels; k++) specs[k] = temp ;
+		PipelineInit(&pipeline, specs, channels) ;
+		PipelineStart(&pipeline) ;
+
+		clock_gettime(CLOCK_MONOTONIC, &start) ;
+		blocks = 0 ;
+		do
+			{
+			PipelineRun(&pipeline, AdcDmaWait()) ;
+			blocks++ ;
+			clock_gettime(CLOCK_MONOTONIC, &now) ;
+			seconds = (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9 ;
+			} while (seconds < 0.5) ;
+		AdcDmaStop() ;
+
+		printf("%u,%u,%u,%.0f,%.2f\n", (unsigned) channels, (unsigned) blocks, (unsigned) AdcDmaOverruns(),
+			(double) channels * ADC_BLOCK_SCANS * blocks / seconds,
+			1e9 * seconds / ((double) channels * ADC_BLOCK_SCANS * blocks)) ;
+		}
+	return outputs == 0 ;
+	}
+
+#endif
@@ -0,0 +1,84 @@
+/*
+	Multi-channel sensor pipeline on top of adcdma.
+
+	Each channel is declared by a PIPE_SPEC: the ADC input, a calibration
+	table (two points for a straight MxPlusB-style line), a filter, a
+	decimation ratio and a sink. The inputs are scanned in the order the
+	specs are given. PipelineRun takes one block from the ADC and runs
+	every channel through the same stages in turn:
+
+		calibrate	every sample with CalibSamples
+		decimate	average each run of decimate samples into one value
+		filter		FilterNext on each decimated value
+		sink		hand the result to the channel's sink
+
+	Decimation runs across block boundaries, so decimate need not divide
+	ADC_BLOCK_SCANS. Adding a channel is one more PIPE_SPEC.
+
+	A host build of pipeline.c with PIPELINE_BENCH defined measures
+	throughput against the simulated ADC as the channel count grows:
+
+		gcc -O2 -DPIPELINE_BENCH -o pipeline pipeline.c adcdma.c calib.c scale.c filter.c -lpthread && ./pipeline
+*/
+
+#ifndef PIPELINE_H
+#define	PIPELINE_H
+
+#include <stdint.h>
+#include "adcdma.h"
+#include "calib.h"
+#include "filter.h"
+
+struct PIPE_CHANNEL ;
+
+typedef void			(*PIPE_SINK)(struct PIPE_CHANNEL *channel, int32_t value) ;
+
+typedef struct
+	{
+	const char *		name ;
+	uint8_t				input ;		// ADC1 channel number
+	const CALIB_POINT *	points ;	// raw -> value
+	uint32_t			pointCount ;
+	FILTER_KIND			filter ;
+	uint32_t			param ;		// Depth, or shift for FILTER_EMA
+	uint32_t			decimate ;	// Samples averaged into each value
+	PIPE_SINK			sink ;
+	void *				context ;	// For the sink
+	} PIPE_SPEC ;
+
+typedef struct PIPE_CHANNEL
+	{
+	const PIPE_SPEC *	spec ;
+	CALIB				calib ;
+	FILTER				filter ;
+	uint32_t			count ;		// Samples toward the next value
+	int64_t				total ;
+	int64_t				rawTotal ;
+	int32_t				raw ;		// Average raw reading behind the last value
+	} PIPE_CHANNEL ;
+
+typedef struct
+	{
+	uint32_t			count ;
+	PIPE_CHANNEL		channel[ADC_MAX_CHANNELS] ;
+	} PIPELINE ;
+
+// Context for SinkAlarm
+typedef struct
+	{
+	int32_t				low ;		// Raised outside low..high, cleared
+	int32_t				high ;		// once hysteresis back inside
+	int32_t				hysteresis ;
+	int					active ;
+	void				(*notify)(int active) ;		// NULL if not wanted
+	} PIPE_ALARM ;
+
+extern int				PipelineInit(PIPELINE *pipeline, const PIPE_SPEC specs[], uint32_t count) ;
+extern void				PipelineStart(const PIPELINE *pipeline) ;
+extern void				PipelineRun(PIPELINE *pipeline, const uint16_t block[]) ;
+
+// Ready-made sinks
+extern void				SinkLog(struct PIPE_CHANNEL *channel, int32_t value) ;
+extern void				SinkAlarm(struct PIPE_CHANNEL *channel, int32_t value) ;
+
+#endif
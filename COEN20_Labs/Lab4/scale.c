@@ -0,0 +1,73 @@
+/*
+	Batched linear scaling.
+
+	MxPlusB computes p = x*mtop, adds +/-mbtm/2 according to the sign of
+	p*mbtm, and divides by mbtm with SDIV. Here the division is done on
+	magnitudes with the Granlund-Montgomery method: for a divisor d with
+	l = ceil(log2(d)) and m = floor(2^32 * (2^l - d) / d) + 1,
+
+		t = (n * m) >> 32
+		n / d = (t + ((n - t) >> min(l, 1))) >> max(l - 1, 0)
+
+	which is exact for every 32-bit n. The sign is put back afterwards,
+	the same truncation toward zero SDIV gives.
+*/
+
+#include <stdint.h>
+#include "scale.h"
+
+static int32_t			Scale(const SCALE *scale, int32_t x) ;
+
+void ScaleInit(SCALE *scale, int32_t mtop, int32_t mbtm, int32_t b)
+	{
+	uint32_t d, l ;
+
+	scale->mtop = mtop ;
+	scale->mbtm = mbtm ;
+	scale->b = b ;
+
+	// MxPlusB halves +/-mbtm with SDIV, so both truncate toward zero
+	scale->halfPos = mbtm / 2 ;
+	scale->halfNeg = (int32_t) (0u - (uint32_t) mbtm) / 2 ;
+
+	d = (mbtm < 0) ? 0u - (uint32_t) mbtm : (uint32_t) mbtm ;
+	scale->divisor = d ;
+	if (d == 0)
+		{
+		scale->magic = scale->shift1 = scale->shift2 = 0 ;
+		return ;
+		}
+
+	l = (d == 1) ? 0 : 32 - __builtin_clz(d - 1) ;
+	scale->magic = (uint32_t) (((((uint64_t) 1 << l) - d) << 32) / d) + 1 ;
+	scale->shift1 = (l < 1) ? l : 1 ;
+	scale->shift2 = (l < 1) ? 0 : l - 1 ;
+	}
+
+int32_t ScaleOne(const SCALE *scale, int32_t x)
+	{
+	return Scale(scale, x) ;
+	}
+
+void ScaleSamples(const SCALE *scale, int32_t dst[], const int32_t src[], uint32_t count)
+	{
+	while (count-- != 0) *dst++ = Scale(scale, *src++) ;
+	}
+
+static int32_t Scale(const SCALE *scale, int32_t x)
+	{
+	uint32_t p, n, mag, t, q ;
+
+	if (scale->divisor == 0) return scale->b ;
+
+	// All arithmetic modulo 2^32, as MxPlusB's MUL and ADD
+	p = (uint32_t) x * (uint32_t) scale->mtop ;
+	n = p + (uint32_t) (((int32_t) (p * (uint32_t) scale->mbtm) < 0) ? scale->halfNeg : scale->halfPos) ;
+
+	mag = ((int32_t) n < 0) ? 0u - n : n ;
+	t = (uint32_t) (((uint64_t) mag * scale->magic) >> 32) ;
+	q = (t + ((mag - t) >> scale->shift1)) >> scale->shift2 ;
+	if (((int32_t) n ^ scale->mbtm) < 0) q = 0u - q ;
+
+	return (int32_t) (q + (uint32_t) scale->b) ;
+	}
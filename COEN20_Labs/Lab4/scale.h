@@ -0,0 +1,34 @@
+/*
+	Batched linear scaling: the same rounded x*mtop/mbtm + b as MxPlusB,
+	applied to one sample or an array of them. ScaleInit works out a
+	reciprocal of mbtm once, so converting a sample takes multiplies
+	and shifts instead of an SDIV.
+
+	Results match MxPlusB bit for bit, including its 32-bit wraparound:
+	x*mtop is taken modulo 2^32, halves round away from zero, and a zero
+	mbtm gives b (SDIV by zero returns zero).
+*/
+
+#ifndef SCALE_H
+#define	SCALE_H
+
+#include <stdint.h>
+
+typedef struct
+	{
+	int32_t				mtop ;
+	int32_t				mbtm ;
+	int32_t				b ;
+	int32_t				halfPos ;	// Rounding term when x*mtop*mbtm >= 0
+	int32_t				halfNeg ;	// ... and when it is negative
+	uint32_t			divisor ;	// |mbtm|
+	uint32_t			magic ;		// Reciprocal of divisor
+	uint8_t				shift1 ;
+	uint8_t				shift2 ;
+	} SCALE ;
+
+extern void				ScaleInit(SCALE *scale, int32_t mtop, int32_t mbtm, int32_t b) ;
+extern int32_t			ScaleOne(const SCALE *scale, int32_t x) ;
+extern void				ScaleSamples(const SCALE *scale, int32_t dst[], const int32_t src[], uint32_t count) ;
+
+#endif
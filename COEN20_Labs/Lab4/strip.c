@@ -0,0 +1,251 @@
+/*
+	Scrolling strip chart.
+
+	Buffer column (column + x) % width holds screen column x. Scrolling
+	advances column by one, which brings the old leftmost column around
+	to the right edge; that column alone is cleared from the background
+	column, so a scroll touches height pixels instead of the whole chart.
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include "strip.h"
+
+#ifdef STRIP_TEST
+#include <stdio.h>
+#include <stdlib.h>
+#endif
+
+static void				Plot(STRIP *strip, int x, int y, uint32_t color) ;
+
+void StripInit(STRIP *strip, uint32_t *screen, uint32_t stride, uint32_t *pixels, uint32_t width, uint32_t height)
+	{
+	uint32_t y ;
+
+	if (height > STRIP_MAX_HEIGHT) height = STRIP_MAX_HEIGHT ;
+
+	strip->screen	= screen ;
+	strip->stride	= stride ;
+	strip->pixels	= pixels ;
+	strip->width	= width ;
+	strip->height	= height ;
+	strip->column	= 0 ;
+	for (y = 0; y < height; y++) strip->background[y] = 0 ;
+	}
+
+void StripBackground(STRIP *strip, uint32_t y, uint32_t color)
+	{
+	if (y < strip->height) strip->background[y] = color ;
+	}
+
+void StripClear(STRIP *strip)
+	{
+	uint32_t *px = strip->pixels ;
+	uint32_t x, y ;
+
+	strip->column = 0 ;
+	for (y = 0; y < strip->height; y++)
+		{
+		for (x = 0; x < strip->width; x++) *px++ = strip->background[y] ;
+		}
+	}
+
+void StripScroll(STRIP *strip)
+	{
+	uint32_t *px ;
+	uint32_t y ;
+
+	// The column leaving on the left re-enters on the right
+	px = strip->pixels + strip->column ;
+	for (y = 0; y < strip->height; y++, px += strip->width) *px = strip->background[y] ;
+	if (++strip->column == strip->width) strip->column = 0 ;
+	}
+
+void StripLine(STRIP *strip, int x0, int y0, int x1, int y1, uint32_t color)
+	{
+	int dx, dy, sx, sy, err, e2 ;
+
+	// Bresenham; pixels outside the chart are skipped
+	dx = (x1 > x0) ? x1 - x0 : x0 - x1 ;
+	dy = (y1 > y0) ? y0 - y1 : y1 - y0 ;
+	sx = (x0 < x1) ? 1 : -1 ;
+	sy = (y0 < y1) ? 1 : -1 ;
+	err = dx + dy ;
+	while (1)
+		{
+		Plot(strip, x0, y0, color) ;
+		if (x0 == x1 && y0 == y1) break ;
+		e2 = 2*err ;
+		if (e2 >= dy)
+			{
+			err += dy ;
+			x0 += sx ;
+			}
+		if (e2 <= dx)
+			{
+			err += dx ;
+			y0 += sy ;
+			}
+		}
+	}
+
+void StripBlit(const STRIP *strip)
+	{
+	const uint32_t *src = strip->pixels ;
+	uint32_t *dst = strip->screen ;
+	uint32_t left, right, y ;
+
+	right = strip->width - strip->column ;	// Buffer columns column..width-1
+	left = strip->column ;					// then 0..column-1
+	for (y = 0; y < strip->height; y++, src += strip->width, dst += strip->stride)
+		{
+		memcpy(dst, src + left, right * sizeof(uint32_t)) ;
+		memcpy(dst + right, src, left * sizeof(uint32_t)) ;
+		}
+	}
+
+static void Plot(STRIP *strip, int x, int y, uint32_t color)
+	{
+	uint32_t column ;
+
+	if (x < 0 || y < 0 || x >= (int) strip->width || y >= (int) strip->height) return ;
+	column = strip->column + x ;
+	if (column >= strip->width) column -= strip->width ;
+	strip->pixels[y*strip->width + column] = color ;
+	}
+
+#ifdef STRIP_TEST
+
+// The chart sits inside a larger simulated frame buffer whose border must
+// never be written; the reference keeps the chart in screen order, so
+// scrolling it really does move every pixel left
+#define	MARGIN			3
+#define	BORDER			0xDEADBEEF
+#define	STEPS			5000
+
+static int				Check(uint32_t width, uint32_t height) ;
+static void				RefLine(int x0, int y0, int x1, int y1, uint32_t color) ;
+static void				RefPlot(int x, int y, uint32_t color) ;
+
+static uint32_t			frame[(STRIP_MAX_HEIGHT + 2*MARGIN) * (320 + 2*MARGIN)] ;
+static uint32_t			pixels[STRIP_MAX_HEIGHT * 320] ;
+static uint32_t			ref[STRIP_MAX_HEIGHT][320] ;
+static uint32_t			refWidth, refHeight ;
+
+int main(void)
+	{
+	static const uint32_t sizes[][2] = {{1, 1}, {2, 3}, {7, 5}, {64, 1}, {240, 100}, {320, STRIP_MAX_HEIGHT}} ;
+	uint32_t k ;
+	int errors = 0 ;
+
+	for (k = 0; k < sizeof(sizes)/sizeof(sizes[0]); k++)
+		{
+		errors += Check(sizes[k][0], sizes[k][1]) ;
+		}
+	printf("%d wrong frames\n", errors) ;
+	return errors != 0 ;
+	}
+
+// Random scrolls, lines (some partly or wholly off the chart) and
+// background changes, blitting and comparing the frame after each
+static int Check(uint32_t width, uint32_t height)
+	{
+	static STRIP strip ;
+	uint32_t stride, x, y, k, step, color, *px ;
+	int errors, x0, y0, x1, y1, w, h ;
+
+	stride = width + 2*MARGIN ;
+	for (k = 0; k < stride * (height + 2*MARGIN); k++) frame[k] = BORDER ;
+	StripInit(&strip, frame + MARGIN*stride + MARGIN, stride, pixels, width, height) ;
+	StripClear(&strip) ;
+	refWidth = width ;
+	refHeight = height ;
+	for (y = 0; y < height; y++) for (x = 0; x < width; x++) ref[y][x] = 0 ;
+
+	w = (int) width ;
+	h = (int) height ;
+	errors = 0 ;
+	for (step = 0; step < STEPS; step++)
+		{
+		color = (uint32_t) rand() ;
+		switch (rand() % 8)
+			{
+			case 0:
+				y = rand() % height ;
+				StripBackground(&strip, y, color) ;
+				if (rand() % 4 != 0) break ;
+				StripClear(&strip) ;
+				for (y = 0; y < height; y++) for (x = 0; x < width; x++) ref[y][x] = strip.background[y] ;
+				break ;
+			case 1: case 2: case 3:
+				StripScroll(&strip) ;
+				for (y = 0; y < height; y++)
+					{
+					memmove(ref[y], ref[y] + 1, (width - 1) * sizeof(uint32_t)) ;
+					ref[y][width - 1] = strip.background[y] ;
+					}
+				break ;
+			default:
+				x0 = rand() % (w + 8) - 4 ;
+				y0 = rand() % (h + 8) - 4 ;
+				x1 = rand() % (w + 8) - 4 ;
+				y1 = rand() % (h + 8) - 4 ;
+				StripLine(&strip, x0, y0, x1, y1, color) ;
+				RefLine(x0, y0, x1, y1, color) ;
+				break ;
+			}
+
+		StripBlit(&strip) ;
+		px = frame ;
+		for (y = 0; y < height + 2*MARGIN; y++)
+			{
+			for (x = 0; x < stride; x++, px++)
+				{
+				if (y < MARGIN || y >= height + MARGIN || x < MARGIN || x >= width + MARGIN)
+					{
+					if (*px != BORDER) break ;
+					}
+				else if (*px != ref[y - MARGIN][x - MARGIN]) break ;
+				}
+			if (x < stride) break ;
+			}
+		if (y < height + 2*MARGIN) errors++ ;
+		}
+	if (errors != 0) printf("%u x %u: %d wrong frames\n", (unsigned) width, (unsigned) height, errors) ;
+	return errors ;
+	}
+
+// Bresenham again, but straight into screen coordinates
+static void RefLine(int x0, int y0, int x1, int y1, uint32_t color)
+	{
+	int dx, dy, sx, sy, err, e2 ;
+
+	dx = abs(x1 - x0) ;
+	dy = -abs(y1 - y0) ;
+	sx = (x0 < x1) ? 1 : -1 ;
+	sy = (y0 < y1) ? 1 : -1 ;
+	err = dx + dy ;
+	while (1)
+		{
+		RefPlot(x0, y0, color) ;
+		if (x0 == x1 && y0 == y1) break ;
+		e2 = 2*err ;
+		if (e2 >= dy)
+			{
+			err += dy ;
+			x0 += sx ;
+			}
+		if (e2 <= dx)
+			{
+			err += dx ;
+			y0 += sy ;
+			}
+		}
+	}
+
+static void RefPlot(int x, int y, uint32_t color)
+	{
+	if (x >= 0 && y >= 0 && x < (int) refWidth && y < (int) refHeight) ref[y][x] = color ;
+	}
+
+#endif
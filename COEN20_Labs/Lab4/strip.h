@@ -0,0 +1,42 @@
+/*
+	Scrolling strip chart. The chart is drawn into an off-screen buffer
+	whose columns are used circularly: scrolling left one pixel just
+	moves the column offset and clears the column that comes into view
+	on the right, then StripBlit copies the buffer to the screen in two
+	pieces per row (either side of the wrap point).
+
+	The screen is only ever addressed as base + y*stride + x, so a plain
+	array in a host build can stand in for the LCD frame buffer.
+	Coordinates are relative to the chart's top left corner. A host
+	build of strip.c with STRIP_TEST defined does exactly that, checking
+	every blit against a chart kept in screen order:
+
+		gcc -O2 -DSTRIP_TEST -o strip strip.c && ./strip
+*/
+
+#ifndef STRIP_H
+#define	STRIP_H
+
+#include <stdint.h>
+
+#define	STRIP_MAX_HEIGHT	320
+
+typedef struct
+	{
+	uint32_t *			screen ;	// Top left pixel of the chart on screen
+	uint32_t			stride ;	// Pixels per screen row
+	uint32_t *			pixels ;	// width*height off-screen pixels
+	uint32_t			width ;
+	uint32_t			height ;
+	uint32_t			column ;	// Buffer column shown at x = 0
+	uint32_t			background[STRIP_MAX_HEIGHT] ;	// Clear column, top to bottom
+	} STRIP ;
+
+extern void				StripInit(STRIP *strip, uint32_t *screen, uint32_t stride, uint32_t *pixels, uint32_t width, uint32_t height) ;
+extern void				StripBackground(STRIP *strip, uint32_t y, uint32_t color) ;
+extern void				StripClear(STRIP *strip) ;
+extern void				StripScroll(STRIP *strip) ;
+extern void				StripLine(STRIP *strip, int x0, int y0, int x1, int y1, uint32_t color) ;
+extern void				StripBlit(const STRIP *strip) ;
+
+#endif
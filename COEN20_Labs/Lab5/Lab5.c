@@ -15,10 +15,21 @@
 #include "library.h"
 #include "graphics.h"
 #include "touch.h"
+#include "fill.h"
+#include "matrix.h"
+#include "mesh.h"
+#include "quat.h"
 
 // Function to be implemented in assembly language:
 extern void MatrixMultiply(int32_t a[3][3], int32_t b[3][3], int32_t c[3][3]) ;
 
+// Kernels in Lab5.S with the multiply-accumulates in line: a = b * c.
+// The FMA kernel needs the FPU, so a FIXED_POINT build leaves it out.
+#ifndef FIXED_POINT
+extern void MatrixMultiplyFMA(float a[3][3], float b[3][3], float c[3][3]) ;
+#endif
+extern void MatrixMultiplyQ16(int32_t a[3][3], int32_t b[3][3], int32_t c[3][3]) ;
+
 // Public function defined in this file to be called from assembly
 int32_t MultAndAdd(int32_t a, int32_t b, int32_t c)
 	{
@@ -45,24 +56,17 @@ typedef uint32_t			CLR_RGB32 ;
 typedef	int					SCREEN_COORDINATE[SCREEN_DIMENSIONS] ;
 
 #define	FRAME_DIMENSIONS	3	// x, y, & z
-typedef float				VECTOR[FRAME_DIMENSIONS] ;
+typedef SCALAR				VECTOR[FRAME_DIMENSIONS] ;	// float, or Q16 if FIXED_POINT
 typedef VECTOR				MATRIX[FRAME_DIMENSIONS] ;
 
 #define	MATRIX_ROWS			(sizeof(MATRIX)/sizeof(VECTOR))
-#define	MATRIX_COLS			(sizeof(VECTOR)/sizeof(float))
-
-typedef struct
-	{
-	float 					x ;
-	float					y ;
-	float					z ;
-	} VERTEX ;
+#define	MATRIX_COLS			(sizeof(VECTOR)/sizeof(SCALAR))
 
 #define	VERTICES			3
 
 typedef struct
 	{
-	VERTEX *				vertices[VERTICES] ;
+	uint8_t					vertices[VERTICES] ;	// Indices into the mesh
 	CLR_INDEX				clr_index ;
 	} TRIANGLE ;
 
@@ -128,7 +132,6 @@ typedef struct
 
 extern sFONT				Font8, Font12, Font16, Font20, Font24 ;
 
-#define	PI					3.14159
 #define	ENTRIES(a)			(sizeof(a)/sizeof(a[0]))
 
 #define	FRAME_ROWS			240
@@ -152,6 +155,8 @@ typedef CLR_INDEX			FRAME[FRAME_ROWS][FRAME_COLS] ;
 
 #define	SIZE				60.0
 
+#define	STEP				((ANGLE) (0x10000 / 50))	// Turn per frame about each axis, 7.2 degrees
+
 #define	ERR_FONT			Font12
 #define	ERR_BRDR_COLOR		COLOR_BLACK
 #define	ERR_BGND_COLOR		COLOR_RED
@@ -162,6 +167,8 @@ typedef CLR_INDEX			FRAME[FRAME_ROWS][FRAME_COLS] ;
 
 #define	CPU_CLOCK_SPEED_MHZ	168
 
+#define	RENORMALIZE			16		// Frames between renormalizing the orientation; 0 = never
+
 static void					Adjust(SLIDER *slider) ;
 static int32_t				Between(uint32_t min, uint32_t val, uint32_t max) ;
 static void					BtmFlatTriangle(int x1, int x2, int xMin, int yMin, int yMax) ;
@@ -172,19 +179,19 @@ static void					ChromArtXferFrameBuffer(CLR_RGB32 *screen_pixels, FRAME frame_pi
 static uint32_t				GetTimeout(uint32_t msec) ;
 static void					DisplaySpeed(SLIDER *slider) ;
 static void					Error(char *function, char *format, ...) ;
-static void					GetScreenCoordinates(SCREEN_COORDINATE screen_coordinates[VERTICES], VERTEX *vertices[VERTICES]) ;
+static void					GetScreenCoordinates(SCREEN_COORDINATE screen_coordinates[VERTICES], const uint8_t vertices[VERTICES]) ;
 static void					HorizLine(int x, int y, int width) ;
 static void					IdentityMatrix(MATRIX matrix) ;
 static void					InitializeTouchScreen(void) ;
 static void					InitSlider(SLIDER *slider) ;
 static void					LEDs(int grn_on, int red_on) ;
+static void					MatrixBench(void) ;
 static void					MxM(MATRIX a, MATRIX b, MATRIX c) ;
-static void					MxV(VECTOR dstVector, MATRIX matrix, VECTOR srcVector) ;
 static void					PaintTriangle(TRIANGLE *pTriangle) ;
 static void					PutStringAt(int x, int y, char *fmt, ...) ;
-static void					RotateAboutXAxis(float radians, MATRIX matrix) ;
-static void					RotateAboutYAxis(float radians, MATRIX matrix) ;
-static void					RotateAboutZAxis(float radians, MATRIX matrix) ;
+static void					RotateAboutXAxis(ANGLE angle, MATRIX matrix) ;
+static void					RotateAboutYAxis(ANGLE angle, MATRIX matrix) ;
+static void					RotateAboutZAxis(ANGLE angle, MATRIX matrix) ;
 static void					SanityCheck(void) ;
 static void					SetColorIndex(CLR_INDEX index) ;
 static void					SetFontSize(sFONT *pFont) ;
@@ -192,7 +199,6 @@ static void					TopFlatTriangle(int x1, int x2, int xMax, int yMin, int yMax) ;
 static void					UpdateSlider(SLIDER *slider, uint32_t x) ;
 static void					UpdateValue(SLIDER *slider, uint32_t x) ;
 static BOOL					Visible(TRIANGLE *pTriangle) ;
-static float				VxV(VECTOR vec1, VECTOR vec2) ;
 static void					WaitForTimeout(uint32_t timeout, void (*func)(void)) ;
 
 static uint32_t *			AHB1ENR	= (uint32_t *)	0x40023800 ;
@@ -202,41 +208,53 @@ static CLR_INDEX			clr_index = CLR_INDEX_WHITE ;
 static CLR_RGB32 *			screen_pixels = (CLR_RGB32 *) 0xD0000000 ;
 static FRAME				frame_pixels ;
 
-// Define the vertices of the cube ...
-static VERTEX 				ftl = {X_LEFT,	Y_TOP,		Z_FRONT} ;	// front top left
-static VERTEX 				ftr = {X_RIGHT,	Y_TOP,		Z_FRONT} ;	// front top right
-static VERTEX 				fbl = {X_LEFT,	Y_BOTTOM,	Z_FRONT} ;	// front bottom left
-static VERTEX 				fbr = {X_RIGHT,	Y_BOTTOM,	Z_FRONT} ;	// front bottom right
-static VERTEX 				rtl = {X_LEFT,	Y_TOP,		Z_REAR} ;	// rear top left
-static VERTEX 				rtr = {X_RIGHT,	Y_TOP,		Z_REAR} ;	// rear top right
-static VERTEX 				rbl = {X_LEFT,	Y_BOTTOM,	Z_REAR} ;	// rear bottom left
-static VERTEX 				rbr = {X_RIGHT,	Y_BOTTOM,	Z_REAR} ;	// rear bottom right
+// Name the vertices of the cube by their index in the mesh ...
+enum
+	{
+	ftl, ftr, fbl, fbr,		// front top left, top right, bottom left, bottom right
+	rtl, rtr, rbl, rbr		// rear top left, top right, bottom left, bottom right
+	} ;
+
+// ... and define them, one array per coordinate. The model is never
+// changed; each frame transforms it afresh into mesh.
+static const MESH			model =
+	{
+	8,
+	{S_CONST(X_LEFT),	S_CONST(X_RIGHT),	S_CONST(X_LEFT),	S_CONST(X_RIGHT),			// x
+	 S_CONST(X_LEFT),	S_CONST(X_RIGHT),	S_CONST(X_LEFT),	S_CONST(X_RIGHT)},
+	{S_CONST(Y_TOP),	S_CONST(Y_TOP),		S_CONST(Y_BOTTOM),	S_CONST(Y_BOTTOM),			// y
+	 S_CONST(Y_TOP),	S_CONST(Y_TOP),		S_CONST(Y_BOTTOM),	S_CONST(Y_BOTTOM)},
+	{S_CONST(Z_FRONT),	S_CONST(Z_FRONT),	S_CONST(Z_FRONT),	S_CONST(Z_FRONT),			// z
+	 S_CONST(Z_REAR),	S_CONST(Z_REAR),	S_CONST(Z_REAR),	S_CONST(Z_REAR)}
+	} ;
 
-// Create an array of pointers to the vertices ...
-static VERTEX *				vertices[] = {&ftl, &ftr, &fbl, &fbr, &rtl, &rtr, &rbl, &rbr} ;
+// Where each vertex lands on the screen, found as the mesh is transformed
+static MESH					mesh ;
+static MESH_SCREEN			screen ;
+static const MESH_VIEW		view = {S_CONST(SIZE), S_CONST(X_CENTER), S_CONST(Y_CENTER)} ;
 
 // Define the cube as an array of triangles - two per face.
 // First vertex of each triangle must be at the 90 degree
 // corner & in clockwise order as seen from outside of cube.
 static TRIANGLE				triangles[] =
 	{
-	{{&rtl, &rtr, &ftl},	CLR_INDEX_YELLOW	},	// top
-	{{&ftr, &ftl, &rtr},	CLR_INDEX_YELLOW	},
+	{{rtl, rtr, ftl},	CLR_INDEX_YELLOW	},	// top
+	{{ftr, ftl, rtr},	CLR_INDEX_YELLOW	},
 
-	{{&ftl, &ftr, &fbl},	CLR_INDEX_GREEN		},	// front face
-	{{&fbr, &fbl, &ftr},	CLR_INDEX_GREEN		},
+	{{ftl, ftr, fbl},	CLR_INDEX_GREEN		},	// front face
+	{{fbr, fbl, ftr},	CLR_INDEX_GREEN		},
 
-	{{&rtl, &ftl, &rbl},	CLR_INDEX_RED		},	// left side
-	{{&fbl, &rbl, &ftl},	CLR_INDEX_RED		},
+	{{rtl, ftl, rbl},	CLR_INDEX_RED		},	// left side
+	{{fbl, rbl, ftl},	CLR_INDEX_RED		},
 
-	{{&rtl, &rbl, &rtr},	CLR_INDEX_CYAN		},	// rear face
-	{{&rbr, &rtr, &rbl},	CLR_INDEX_CYAN		},
+	{{rtl, rbl, rtr},	CLR_INDEX_CYAN		},	// rear face
+	{{rbr, rtr, rbl},	CLR_INDEX_CYAN		},
 
-	{{&rtr, &rbr, &ftr},	CLR_INDEX_BLUE		},	// right side
-	{{&fbr, &ftr, &rbr},	CLR_INDEX_BLUE		},
+	{{rtr, rbr, ftr},	CLR_INDEX_BLUE		},	// right side
+	{{fbr, ftr, rbr},	CLR_INDEX_BLUE		},
 
-	{{&fbl, &fbr, &rbl},	CLR_INDEX_MAGENTA	},	// bottom
-	{{&rbr, &rbl, &fbr},	CLR_INDEX_MAGENTA	}
+	{{fbl, fbr, rbl},	CLR_INDEX_MAGENTA	},	// bottom
+	{{rbr, rbl, fbr},	CLR_INDEX_MAGENTA	}
 	} ;
 
 static uint32_t msec = 60 ; // 20 RPM
@@ -244,26 +262,35 @@ static SLIDER slider = {"Speed", &msec, SLIDER_VMIN, SLIDER_VMAX, SLIDER_XMIN, S
 
 int main()
 	{
-	uint32_t timeout ;
+	uint32_t timeout, frames ;
+	QUAT orientation, step ;
 	MATRIX matrix ;
 
 	InitializeHardware(NULL, "Lab 5a: Spinning Cube") ;
 	InitializeTouchScreen() ;
 	SanityCheck() ;
+#ifdef MATRIX_BENCH
+	MatrixBench() ;
+#endif
 	ChromArtInitialize() ;
 	InitSlider(&slider) ;
 
-	// Create the transformation matrix
+	// Create the transformation matrix for one frame
 	IdentityMatrix(matrix) ;
-	RotateAboutXAxis(PI/25, matrix) ;
-	RotateAboutYAxis(PI/25, matrix) ;
-	RotateAboutZAxis(PI/25, matrix) ;
+	RotateAboutXAxis(STEP, matrix) ;
+	RotateAboutYAxis(STEP, matrix) ;
+	RotateAboutZAxis(STEP, matrix) ;
+
+	// Accumulate the rotation as a quaternion rather than
+	// applying the matrix to the vertices frame after frame
+	QuatFromMatrix(&step, (void *) matrix) ;
+	QuatIdentity(&orientation) ;
+	frames = 0 ;
 
 	timeout = GetTimeout(msec) ;
 	for (;;)
 		{
 		TRIANGLE *pTriangle ;
-		VERTEX **ppVertex ;
 		int k ;
 
 		// Let DMA finish copying the frame buffer to the
@@ -274,14 +301,18 @@ int main()
 		while (PushButtonPressed()) ;
 
 		// Erase the frame buffer (remove triangles)
-		memset(frame_pixels, CLR_INDEX_WHITE, sizeof(frame_pixels)) ;
+		FillBlock(frame_pixels, CLR_INDEX_WHITE, sizeof(frame_pixels)) ;
 
-		// Transform all the vertices
-		ppVertex = &vertices[0] ;
-		for (k = 0; k < ENTRIES(vertices); k++, ppVertex++)
+		// Turn by one more step and transform the original
+		// vertices to the new orientation; find them on the screen
+		QuatMultiply(&orientation, &step, &orientation) ;
+		if (++frames == RENORMALIZE)
 			{
-			MxV((float *) *ppVertex, matrix, (float *) *ppVertex) ;
+			QuatNormalize(&orientation) ;
+			frames = 0 ;
 			}
+		QuatToMatrix(matrix, &orientation) ;
+		MeshTransform(&mesh, &screen, &model, (void *) matrix, &view) ;
 
 		// Paint visible triangles to the frame buffer
 		pTriangle = &triangles[0] ;
@@ -448,32 +479,35 @@ static void PaintTriangle(TRIANGLE *pTriangle)
 
 static BOOL Visible(TRIANGLE *pTriangle)
 	{
-	float dx1, dy1, dx2, dy2 ;
+	SCALAR dx1, dy1, dx2, dy2 ;
+	int v0, v1, v2 ;
 
 	// Surface normal is cross-product of two sides
-	dx1 = pTriangle->vertices[0]->x - pTriangle->vertices[1]->x ;
-	dy1 = pTriangle->vertices[0]->y - pTriangle->vertices[1]->y ;
+	v0 = pTriangle->vertices[0] ;
+	v1 = pTriangle->vertices[1] ;
+	v2 = pTriangle->vertices[2] ;
+
+	dx1 = mesh.x[v0] - mesh.x[v1] ;
+	dy1 = mesh.y[v0] - mesh.y[v1] ;
 
-	dx2 = pTriangle->vertices[1]->x - pTriangle->vertices[2]->x ;
-	dy2 = pTriangle->vertices[1]->y - pTriangle->vertices[2]->y ;
+	dx2 = mesh.x[v1] - mesh.x[v2] ;
+	dy2 = mesh.y[v1] - mesh.y[v2] ;
 
 	// Return TRUE if surface normal points towards us
-	return (dx1 * dy2) < (dy1 * dx2) ;
+	return S_MUL(dx1, dy2) < S_MUL(dy1, dx2) ;
 	}
 
-static void GetScreenCoordinates(SCREEN_COORDINATE screen_coordinates[VERTICES], VERTEX *vertices[VERTICES])
+static void GetScreenCoordinates(SCREEN_COORDINATE screen_coordinates[VERTICES], const uint8_t vertices[VERTICES])
 	{
-	VERTEX **ppVertex ;
 	int k, x, y ;
 
-	// Convert floating-point vertex coordinates
-	// to screen row and column coordinates
-	ppVertex = &vertices[0] ;
-	for (k = 0; k < VERTICES; k++, ppVertex++)
+	// Screen row and column coordinates were found
+	// when the mesh was transformed
+	for (k = 0; k < VERTICES; k++)
 		{
 		int *pPixel = screen_coordinates[k] ;
-		pPixel[0] = X_CENTER + (int) SIZE*(*ppVertex)->x ;
-		pPixel[1] = Y_CENTER + (int) SIZE*(*ppVertex)->y ;
+		pPixel[0] = screen.x[vertices[k]] ;
+		pPixel[1] = screen.y[vertices[k]] ;
 
 		// vertex 0 is at the 90 degree corner;
 		// extend the opposite edge to avoid gap
@@ -485,44 +519,14 @@ static void GetScreenCoordinates(SCREEN_COORDINATE screen_coordinates[VERTICES],
 		}
 	}
 
-static float VxV(VECTOR v1, VECTOR v2)
-	{
-	// Dot Product: Scalar (returned) <-- Vector (v1) * Vector (v2)
-	float sum ;
-	int k ;
-
-	sum = 0.0 ;
-	for (k = 0; k < MATRIX_COLS; k++)
-		{
-		sum += v1[k] * v2[k] ;
-		}
-
-	return sum;
-	}
-
-static void MxV(VECTOR dstVector, MATRIX matrix, VECTOR srcVector)
-	{
-	// Vector (vdst) <-- Matrix (matrix) * Vector (vsrc)
-	float *pFloat, *pMatrixRow ;
-	VECTOR tmpVector ;
-	int row ;
-
-	pFloat = tmpVector ; pMatrixRow = (float *) matrix ;
-	for (row = 0; row < MATRIX_ROWS; row++)
-		{
-		*pFloat++ = VxV(pMatrixRow, srcVector) ;
-		pMatrixRow += MATRIX_COLS ;
-		}
-	memcpy(dstVector, tmpVector, sizeof(tmpVector)) ;
-	}
-
 static void MxM(MATRIX a, MATRIX b, MATRIX c)
 	{
-	// Matrix (a) <-- Matrix (b) * Matrix (c)
-	MATRIX tmpMatrix ;
-
-	MatrixMultiply((void *) tmpMatrix, (void *) b, (void *) c) ;
-	memcpy(a, tmpMatrix, sizeof(tmpMatrix)) ;
+	// Matrix (a) <-- Matrix (b) * Matrix (c); a may be b, but not c
+#ifdef FIXED_POINT
+	MatrixMultiplyQ16(a, b, c) ;
+#else
+	MatrixMultiplyFMA(a, b, c) ;
+#endif
 	}
 
 static void IdentityMatrix(MATRIX matrix)
@@ -530,50 +534,50 @@ static void IdentityMatrix(MATRIX matrix)
 	// matrix <-- Identity matrix
 	static MATRIX ident =
 		{
-		{1.0, 0.0, 0.0},
-		{0.0, 1.0, 0.0},
-		{0.0, 0.0, 1.0}
+		{S_CONST(1.0), S_CONST(0.0), S_CONST(0.0)},
+		{S_CONST(0.0), S_CONST(1.0), S_CONST(0.0)},
+		{S_CONST(0.0), S_CONST(0.0), S_CONST(1.0)}
 		} ;
 
 	memcpy(matrix, ident, sizeof(MATRIX)) ;
 	}
 
-static void RotateAboutZAxis(float radians, MATRIX matrix)
+static void RotateAboutZAxis(ANGLE angle, MATRIX matrix)
 	{
 	MATRIX tmpMatrix ;
 
 	memset(tmpMatrix, 0, sizeof(MATRIX)) ;
-	tmpMatrix[0][0] = +cos(radians) ;
-	tmpMatrix[0][1] = -sin(radians) ;
-	tmpMatrix[1][0] = +sin(radians) ;
-	tmpMatrix[1][1] = +cos(radians) ;
-	tmpMatrix[2][2] = +1.0 ;
+	tmpMatrix[0][0] = +S_COS(angle) ;
+	tmpMatrix[0][1] = -S_SIN(angle) ;
+	tmpMatrix[1][0] = +S_SIN(angle) ;
+	tmpMatrix[1][1] = +S_COS(angle) ;
+	tmpMatrix[2][2] = S_CONST(1.0) ;
 	MxM(matrix, matrix, tmpMatrix) ;
 	}
 
-static void RotateAboutYAxis(float radians, MATRIX matrix)
+static void RotateAboutYAxis(ANGLE angle, MATRIX matrix)
 	{
 	MATRIX tmpMatrix ;
 
 	memset(tmpMatrix, 0, sizeof(MATRIX)) ;
-	tmpMatrix[0][0] = +cos(radians) ;
-	tmpMatrix[0][2] = +sin(radians) ;
-	tmpMatrix[1][1] = +1.0 ;
-	tmpMatrix[2][0] = -sin(radians) ;
-	tmpMatrix[2][2] = +cos(radians) ;
+	tmpMatrix[0][0] = +S_COS(angle) ;
+	tmpMatrix[0][2] = +S_SIN(angle) ;
+	tmpMatrix[1][1] = S_CONST(1.0) ;
+	tmpMatrix[2][0] = -S_SIN(angle) ;
+	tmpMatrix[2][2] = +S_COS(angle) ;
 	MxM(matrix, matrix, tmpMatrix) ;
 	}
 
-static void RotateAboutXAxis(float radians, MATRIX matrix)
+static void RotateAboutXAxis(ANGLE angle, MATRIX matrix)
 	{
 	MATRIX tmpMatrix ;
 
 	memset(tmpMatrix, 0, sizeof(MATRIX)) ;
-	tmpMatrix[0][0] = +1.0 ;
-	tmpMatrix[1][1] = +cos(radians) ;
-	tmpMatrix[1][2] = -sin(radians) ;
-	tmpMatrix[2][1] = +sin(radians) ;
-	tmpMatrix[2][2] = +cos(radians) ;
+	tmpMatrix[0][0] = S_CONST(1.0) ;
+	tmpMatrix[1][1] = +S_COS(angle) ;
+	tmpMatrix[1][2] = -S_SIN(angle) ;
+	tmpMatrix[2][1] = +S_SIN(angle) ;
+	tmpMatrix[2][2] = +S_COS(angle) ;
 	MxM(matrix, matrix, tmpMatrix) ;
 	}
 
@@ -641,16 +645,19 @@ static void ChromArtXferFrameBuffer(CLR_RGB32 *screen_pixels, FRAME frame_pixels
 
 static void SanityCheck(void)
 	{
-	MATRIX random, ident, product ;
+	float random[3][3], ident[3][3], product[3][3] ;
+	int32_t qRandom[3][3], qIdent[3][3], qProduct[3][3] ;
 	int row, col ;
 
 	LEDs(TRUE, FALSE) ;
-	IdentityMatrix(ident) ;
 	for (row = 0; row < MATRIX_ROWS; row++)
 		{
 		for (col = 0; col < MATRIX_COLS; col++)
 			{
 			random[row][col] = (float) GetRandomNumber() / UINT32_MAX ;
+			ident[row][col] = (row == col) ? 1.0 : 0.0 ;
+			qRandom[row][col] = (int32_t) GetRandomNumber() ;
+			qIdent[row][col] = (row == col) ? 0x10000 : 0 ;	// 1.0 in Q16
 			}
 		}
 	MatrixMultiply((void *) product, (void *) ident, (void *) random) ;
@@ -664,6 +671,118 @@ static void SanityCheck(void)
 				}
 			}
 		}
+
+#ifndef FIXED_POINT
+	MatrixMultiplyFMA(product, ident, random) ;
+	for (row = 0; row < MATRIX_ROWS; row++)
+		{
+		for (col = 0; col < MATRIX_COLS; col++)
+			{
+			if (product[row][col] != random[row][col])
+				{
+				Error("MatrixMultiplyFMA", "Bad Result @ r,c=%d,%d", row, col) ;
+				}
+			}
+		}
+#endif
+
+	MatrixMultiplyQ16(qProduct, qIdent, qRandom) ;
+	for (row = 0; row < MATRIX_ROWS; row++)
+		{
+		for (col = 0; col < MATRIX_COLS; col++)
+			{
+			if (qProduct[row][col] != qRandom[row][col])
+				{
+				Error("MatrixMultiplyQ16", "Bad Result @ r,c=%d,%d", row, col) ;
+				}
+			}
+		}
+	}
+
+// Cycles for one 3x3 product with each kernel, best of several runs.
+// MatrixMultiply calls MultAndAdd for each of its 27 multiply-adds;
+// the others do them in line (FMA only when there is an FPU). Then the
+// cycles for the math of one frame (turn, matrix, transform) in this
+// build's SCALAR type.
+static void MatrixBench(void)
+	{
+#	define	RUNS	10
+#ifdef FIXED_POINT
+	enum {STUDENT, FIXED, Q16, KERNELS} ;
+	static const char *names[] = {"MatrixMultiply", "MatMul3x3F32", "MatrixMultiplyQ16"} ;
+#else
+	enum {STUDENT, FIXED, FMA, Q16, KERNELS} ;
+	static const char *names[] = {"MatrixMultiply", "MatMul3x3F32", "MatrixMultiplyFMA", "MatrixMultiplyQ16"} ;
+#endif
+	float a[3][3], b[3][3], c[3][3] ;
+	int32_t qa[3][3], qb[3][3], qc[3][3] ;
+	uint32_t best[KERNELS], start, cycles, frame ;
+	QUAT orientation, step ;
+	MATRIX matrix ;
+	int row, col, run, which ;
+
+	for (row = 0; row < MATRIX_ROWS; row++)
+		{
+		for (col = 0; col < MATRIX_COLS; col++)
+			{
+			b[row][col] = (float) GetRandomNumber() / UINT32_MAX ;
+			c[row][col] = (float) GetRandomNumber() / UINT32_MAX ;
+			qb[row][col] = (int32_t) (b[row][col] * 0x10000) ;
+			qc[row][col] = (int32_t) (c[row][col] * 0x10000) ;
+			}
+		}
+
+	for (which = 0; which < KERNELS; which++)
+		{
+		best[which] = UINT32_MAX ;
+		for (run = 0; run < RUNS; run++)
+			{
+			start = GetClockCycleCount() ;
+			switch (which)
+				{
+				case STUDENT:	MatrixMultiply((void *) a, (void *) b, (void *) c) ;	break ;
+				case FIXED:		MatMul3x3F32(a, b, c) ;									break ;
+#ifndef FIXED_POINT
+				case FMA:		MatrixMultiplyFMA(a, b, c) ;							break ;
+#endif
+				case Q16:		MatrixMultiplyQ16(qa, qb, qc) ;							break ;
+				}
+			cycles = GetClockCycleCount() - start ;
+			if (cycles < best[which]) best[which] = cycles ;
+			}
+		}
+
+	printf("\n  3x3 PRODUCT (CYCLES):\n\n") ;
+	for (which = 0; which < KERNELS; which++)
+		{
+		printf("  %-18s %5u", names[which], (unsigned) best[which]) ;
+		if (which != STUDENT) printf("  %4.1fx", (float) best[STUDENT] / best[which]) ;
+		printf("\n") ;
+		}
+
+	IdentityMatrix(matrix) ;
+	RotateAboutXAxis(STEP, matrix) ;
+	QuatFromMatrix(&step, (void *) matrix) ;
+	QuatIdentity(&orientation) ;
+	frame = UINT32_MAX ;
+	for (run = 0; run < RUNS; run++)
+		{
+		start = GetClockCycleCount() ;
+		QuatMultiply(&orientation, &step, &orientation) ;
+		QuatToMatrix(matrix, &orientation) ;
+		MeshTransform(&mesh, &screen, &model, (void *) matrix, &view) ;
+		cycles = GetClockCycleCount() - start ;
+		if (cycles < frame) frame = cycles ;
+		}
+#ifdef FIXED_POINT
+	printf("\n  FRAME, Q16 (CYCLES):   %5u\n", (unsigned) frame) ;
+#else
+	printf("\n  FRAME, float (CYCLES): %5u\n", (unsigned) frame) ;
+#endif
+	printf("\n  Press the button to continue\n") ;
+	while (!PushButtonPressed()) ;
+	while (PushButtonPressed()) ;
+	ClearDisplay() ;
 	}
 
 static void SetFontSize(sFONT *pFont)
@@ -0,0 +1,210 @@
+/*
+	General matrix multiply.
+
+	Each element of c is a dot product of a row of a with a column of b.
+	The sum stays in a register while two pointers walk the row (step 1)
+	and the column (step cols), so no index is ever recomputed and no
+	element of c is read or written inside the loop.
+
+	When b is larger than a tile, the work is split into tiles of at
+	most MATRIX_TILE rows of b by MATRIX_TILE columns, taken in order of
+	k. Every row of a then reuses the same tile of b while it is still
+	in cache (on a host; the Cortex-M4 has none, but the loop overhead
+	is the same), and c is read and written once per tile rather than
+	once per multiply.
+*/
+
+#include <stdint.h>
+#include "matrix.h"
+
+#ifdef MATRIX_TEST
+#include <stdio.h>
+#include <stdlib.h>
+#include "harness.h"
+#endif
+
+#define	MIN(a,b)		((a) < (b) ? (a) : (b))
+
+// Defines a tile kernel and the multiply that drives it for element
+// type T, summed in type ACC
+#define	MATMUL(SUFFIX, T, ACC)																	\
+static void Tile##SUFFIX(T c[], const T a[], const T b[], uint32_t rows, uint32_t inner,		\
+	uint32_t cols, uint32_t tileInner, uint32_t tileCols, int first)							\
+	{																							\
+	const T *pa, *pb ;																			\
+	uint32_t row, col, k ;																		\
+	ACC sum ;																					\
+																								\
+	for (row = 0; row < rows; row++, a += inner, c += cols)										\
+		{																						\
+		for (col = 0; col < tileCols; col++)													\
+			{																					\
+			sum = first ? 0 : (ACC) c[col] ;													\
+			pa = a ;																			\
+			pb = b + col ;																		\
+			for (k = 0; k < tileInner; k++, pb += cols) sum += (ACC) *pa++ * (ACC) *pb ;		\
+			c[col] = (T) sum ;																	\
+			}																					\
+		}																						\
+	}																							\
+																								\
+void MatMul##SUFFIX(T c[], const T a[], const T b[], uint32_t rows, uint32_t inner, uint32_t cols)	\
+	{																							\
+	uint32_t k, col ;																			\
+																								\
+	if (inner == 0)																				\
+		{																						\
+		for (k = 0; k < rows * cols; k++) c[k] = 0 ;											\
+		return ;																				\
+		}																						\
+	for (k = 0; k < inner; k += MATRIX_TILE)													\
+		{																						\
+		for (col = 0; col < cols; col += MATRIX_TILE)											\
+			{																					\
+			Tile##SUFFIX(c + col, a + k, b + k*cols + col, rows, inner, cols,					\
+				MIN(MATRIX_TILE, inner - k), MIN(MATRIX_TILE, cols - col), k == 0) ;			\
+			}																					\
+		}																						\
+	}
+
+MATMUL(F32, float, float)
+MATMUL(I32, int32_t, uint32_t)
+
+#ifdef MATRIX_TEST
+
+#define	MAX_DIM			128
+#define	TESTS			2000
+
+static void				Multiply(void) ;
+
+static float			fa[MAX_DIM*MAX_DIM], fb[MAX_DIM*MAX_DIM], fc[MAX_DIM*MAX_DIM], fr[MAX_DIM*MAX_DIM] ;
+static int32_t			ia[MAX_DIM*MAX_DIM], ib[MAX_DIM*MAX_DIM], ic[MAX_DIM*MAX_DIM], ir[MAX_DIM*MAX_DIM] ;
+
+// What one timed pass of Multiply runs
+static void				(*multiplier)(float [], const float [], const float [], uint32_t, uint32_t, uint32_t) ;
+static uint32_t			dim, reps ;
+
+// The textbook triple loop, for reference
+static void NaiveF32(float c[], const float a[], const float b[], uint32_t rows, uint32_t inner, uint32_t cols)
+	{
+	uint32_t row, col, k ;
+
+	for (row = 0; row < rows; row++)
+		{
+		for (col = 0; col < cols; col++)
+			{
+			c[row*cols + col] = 0 ;
+			for (k = 0; k < inner; k++) c[row*cols + col] += a[row*inner + k] * b[k*cols + col] ;
+			}
+		}
+	}
+
+static void NaiveI32(int32_t c[], const int32_t a[], const int32_t b[], uint32_t rows, uint32_t inner, uint32_t cols)
+	{
+	uint32_t row, col, k, sum ;
+
+	for (row = 0; row < rows; row++)
+		{
+		for (col = 0; col < cols; col++)
+			{
+			sum = 0 ;
+			for (k = 0; k < inner; k++) sum += (uint32_t) a[row*inner + k] * (uint32_t) b[k*cols + col] ;
+			c[row*cols + col] = sum ;
+			}
+		}
+	}
+
+static void Randomize(uint32_t count)
+	{
+	uint32_t k ;
+
+	for (k = 0; k < count; k++)
+		{
+		fa[k] = (float) rand() / RAND_MAX - 0.5f ;
+		fb[k] = (float) rand() / RAND_MAX - 0.5f ;
+		ia[k] = rand() - RAND_MAX/2 ;	// Large enough to overflow
+		ib[k] = rand() - RAND_MAX/2 ;
+		}
+	}
+
+static int Same(const void *x, const void *y, uint32_t count)
+	{
+	const uint32_t *p = x, *q = y ;
+
+	while (count-- != 0) if (*p++ != *q++) return 0 ;
+	return 1 ;
+	}
+
+static int CheckFixed(void)
+	{
+	int errors = 0 ;
+
+	Randomize(16) ;
+#	define	FIXED(N)																			\
+	MatMul##N##x##N##F32((void *) fc, (void *) fa, (void *) fb) ;								\
+	NaiveF32(fr, fa, fb, N, N, N) ;																\
+	if (!Same(fc, fr, N*N)) printf("MatMul%dx%dF32 failed\n", N, N), errors++ ;					\
+	MatMul##N##x##N##I32((void *) ic, (void *) ia, (void *) ib) ;								\
+	NaiveI32(ir, ia, ib, N, N, N) ;																\
+	if (!Same(ic, ir, N*N)) printf("MatMul%dx%dI32 failed\n", N, N), errors++ ;
+	FIXED(2)
+	FIXED(3)
+	FIXED(4)
+	return errors ;
+	}
+
+// Shortest of 5 passes, each of reps n x n products
+static double PerMAC(void (*multiply)(float [], const float [], const float [], uint32_t, uint32_t, uint32_t), uint32_t n)
+	{
+	multiplier = multiply ;
+	dim = n ;
+	reps = 1 + 2000000 / (n*n*n) ;
+	return (double) HarnessBest(Multiply, 5) / reps / ((double) n*n*n) ;
+	}
+
+static void Multiply(void)
+	{
+	uint32_t r ;
+
+	for (r = 0; r < reps; r++) (*multiplier)(fc, fa, fb, dim, dim, dim) ;
+	}
+
+int main(void)
+	{
+	static const uint32_t sizes[] = {2, 3, 4, 8, 16, 32, 64, 128} ;
+	uint32_t test, rows, inner, cols, k ;
+	int errors ;
+
+	errors = CheckFixed() ;
+	for (test = 0; test < TESTS; test++)
+		{
+		rows	= 1 + rand() % (test < TESTS/2 ? 20 : MAX_DIM) ;
+		inner	= 1 + rand() % (test < TESTS/2 ? 20 : MAX_DIM) ;
+		cols	= 1 + rand() % (test < TESTS/2 ? 20 : MAX_DIM) ;
+		Randomize(MAX_DIM*MAX_DIM) ;
+
+		MatMulF32(fc, fa, fb, rows, inner, cols) ;
+		NaiveF32(fr, fa, fb, rows, inner, cols) ;
+		if (!Same(fc, fr, rows*cols))
+			{
+			if (errors++ < 10) printf("MatMulF32 %ux%u * %ux%u failed\n", rows, inner, inner, cols) ;
+			}
+
+		MatMulI32(ic, ia, ib, rows, inner, cols) ;
+		NaiveI32(ir, ia, ib, rows, inner, cols) ;
+		if (!Same(ic, ir, rows*cols))
+			{
+			if (errors++ < 10) printf("MatMulI32 %ux%u * %ux%u failed\n", rows, inner, inner, cols) ;
+			}
+		}
+	printf("%u random products, %d errors\n\n", TESTS, errors) ;
+
+	printf("n,naive ns/MAC,MatMulF32 ns/MAC\n") ;
+	for (k = 0; k < sizeof(sizes)/sizeof(sizes[0]); k++)
+		{
+		printf("%u,%.3f,%.3f\n", sizes[k], PerMAC(NaiveF32, sizes[k]), PerMAC(MatMulF32, sizes[k])) ;
+		}
+	return errors != 0 ;
+	}
+
+#endif
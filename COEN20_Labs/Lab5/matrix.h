@@ -0,0 +1,56 @@
+/*
+	Matrix multiply for row-major matrices of any size.
+
+	MatMulF32 and MatMulI32 compute c = a * b, where a is rows x inner,
+	b is inner x cols and c is rows x cols; c must not overlap a or b.
+	Integer products wrap around. Each sum is formed in order of k, as in
+	the textbook triple loop, so float results match it exactly unless
+	the compiler fuses multiplies and adds differently in the two.
+
+	MATRIX_FIXED(N, T, ACC, SUFFIX) defines MatMul<N>x<N><SUFFIX> for
+	square matrices of type T summed in type ACC (unsigned for integers,
+	so overflow wraps). Every trip count is a compile-time constant, so
+	the compiler unrolls them completely. 2x2, 3x3 and 4x4 float and
+	int32_t versions are instantiated below.
+
+	A host build of matrix.c with MATRIX_TEST defined checks every
+	kernel against a naive reference and reports time per
+	multiply-accumulate:
+
+		gcc -O2 -DMATRIX_TEST -I../Common -o matrix matrix.c ../Common/harness.c && ./matrix
+*/
+
+#ifndef MATRIX_H
+#define	MATRIX_H
+
+#include <stdint.h>
+
+#define	MATRIX_TILE		16		// Rows of b (and columns of c) per tile
+
+extern void				MatMulF32(float c[], const float a[], const float b[], uint32_t rows, uint32_t inner, uint32_t cols) ;
+extern void				MatMulI32(int32_t c[], const int32_t a[], const int32_t b[], uint32_t rows, uint32_t inner, uint32_t cols) ;
+
+#define	MATRIX_FIXED(N, T, ACC, SUFFIX)															\
+static inline void MatMul##N##x##N##SUFFIX(T c[N][N], const T a[N][N], const T b[N][N])			\
+	{																							\
+	int row, col, k ;																			\
+	ACC sum ;																					\
+	for (row = 0; row < (N); row++)																\
+		{																						\
+		for (col = 0; col < (N); col++)															\
+			{																					\
+			sum = 0 ;																			\
+			for (k = 0; k < (N); k++) sum += (ACC) a[row][k] * (ACC) b[k][col] ;				\
+			c[row][col] = (T) sum ;																\
+			}																					\
+		}																						\
+	}
+
+MATRIX_FIXED(2, float, float, F32)
+MATRIX_FIXED(3, float, float, F32)
+MATRIX_FIXED(4, float, float, F32)
+MATRIX_FIXED(2, int32_t, uint32_t, I32)
+MATRIX_FIXED(3, int32_t, uint32_t, I32)
+MATRIX_FIXED(4, int32_t, uint32_t, I32)
+
+#endif
@@ -0,0 +1,211 @@
+/*
+	Vertex processing.
+
+	The nine matrix elements and the view are loaded into locals once,
+	so the loop body is nine multiply-adds, two more for the screen
+	position, and loads and stores through pointers that step through
+	the arrays. Nothing is copied through a temporary: each vertex is
+	read completely before its transformed coordinates are stored, so
+	a mesh can be transformed in place.
+*/
+
+#include <stdint.h>
+#include "mesh.h"
+
+#ifdef MESH_BENCH
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "harness.h"
+#include "quat.h"
+#endif
+
+void MeshTransform(MESH *dst, MESH_SCREEN *screen, const MESH *src, const SCALAR matrix[3][3], const MESH_VIEW *view)
+	{
+	SCALAR m00 = matrix[0][0], m01 = matrix[0][1], m02 = matrix[0][2] ;
+	SCALAR m10 = matrix[1][0], m11 = matrix[1][1], m12 = matrix[1][2] ;
+	SCALAR m20 = matrix[2][0], m21 = matrix[2][1], m22 = matrix[2][2] ;
+	SCALAR scale = view->scale, xCenter = view->xCenter, yCenter = view->yCenter ;
+	const SCALAR *px, *py, *pz ;
+	SCALAR *qx, *qy, *qz ;
+	int16_t *sx, *sy ;
+	SCALAR x, y, z, tx, ty ;
+	uint32_t k ;
+
+	px = src->x ; py = src->y ; pz = src->z ;
+	qx = dst->x ; qy = dst->y ; qz = dst->z ;
+	sx = screen->x ; sy = screen->y ;
+	for (k = src->count; k != 0; k--)
+		{
+		x = *px++ ;
+		y = *py++ ;
+		z = *pz++ ;
+
+		tx = S_MUL(m00, x) + S_MUL(m01, y) + S_MUL(m02, z) ;
+		ty = S_MUL(m10, x) + S_MUL(m11, y) + S_MUL(m12, z) ;
+		*qz++ = S_MUL(m20, x) + S_MUL(m21, y) + S_MUL(m22, z) ;
+		*qx++ = tx ;
+		*qy++ = ty ;
+
+		*sx++ = (int16_t) S_INT(xCenter + S_MUL(scale, tx)) ;
+		*sy++ = (int16_t) S_INT(yCenter + S_MUL(scale, ty)) ;
+		}
+	dst->count = src->count ;
+	}
+
+#ifdef MESH_BENCH
+
+// The Lab 5 cube, view and step: the same turn about x, y and z
+#define	FRAMES			10000
+#define	STEP			((ANGLE) (0x10000 / 50))
+#define	RENORMALIZE		16
+#define	REPS			200
+
+static void				Exact(double q[4], const double step[4]) ;
+static void				Frame(QUAT *orientation, const QUAT *step, uint32_t *frames, MESH *mesh, MESH_SCREEN *screen, const MESH *model) ;
+static void				Reference(int16_t *sx, int16_t *sy, const QUAT *q, double x, double y, double z) ;
+static void				SpinBig(void) ;
+static void				SpinCube(void) ;
+
+static const MESH		cube =
+	{
+	8,
+	{S_CONST(-1.0), S_CONST(+1.0), S_CONST(-1.0), S_CONST(+1.0), S_CONST(-1.0), S_CONST(+1.0), S_CONST(-1.0), S_CONST(+1.0)},
+	{S_CONST(+1.0), S_CONST(+1.0), S_CONST(-1.0), S_CONST(-1.0), S_CONST(+1.0), S_CONST(+1.0), S_CONST(-1.0), S_CONST(-1.0)},
+	{S_CONST(-1.0), S_CONST(-1.0), S_CONST(-1.0), S_CONST(-1.0), S_CONST(+1.0), S_CONST(+1.0), S_CONST(+1.0), S_CONST(+1.0)}
+	} ;
+
+static const MESH_VIEW	view = {S_CONST(60.0), S_CONST(120.0), S_CONST(120.0)} ;
+
+static MESH				mesh, big ;
+static MESH_SCREEN		screen ;
+
+// Kept here so the timed passes spin the same cube
+static QUAT				orientation, step ;
+static uint32_t			frames ;
+
+int main(void)
+	{
+	QUAT axis ;
+	double exact[4], qstep[4], half, dot, drift, worst ;
+	uint32_t frame, k, differ ;
+	int16_t rx, ry ;
+	int dx, dy, largest ;
+
+	// The step as a quaternion: a turn about x, then y, then z
+	QuatIdentity(&step) ;
+	axis.w = S_COS(STEP/2) ; axis.x = S_SIN(STEP/2) ; axis.y = axis.z = S_CONST(0.0) ;
+	QuatMultiply(&step, &step, &axis) ;
+	axis.x = S_CONST(0.0) ; axis.y = S_SIN(STEP/2) ;
+	QuatMultiply(&step, &step, &axis) ;
+	axis.y = S_CONST(0.0) ; axis.z = S_SIN(STEP/2) ;
+	QuatMultiply(&step, &step, &axis) ;
+
+	half = STEP * 3.14159265358979 / 0x10000 ;
+	qstep[0] = cos(half)*cos(half)*cos(half) - sin(half)*sin(half)*sin(half) ;
+	qstep[1] = sin(half)*cos(half)*cos(half) + cos(half)*sin(half)*sin(half) ;
+	qstep[2] = cos(half)*sin(half)*cos(half) - sin(half)*cos(half)*sin(half) ;
+	qstep[3] = cos(half)*cos(half)*sin(half) + sin(half)*sin(half)*cos(half) ;
+
+	// Every screen position against one worked out in double from the
+	// same orientation, and the orientation against the exact one
+	QuatIdentity(&orientation) ;
+	exact[0] = 1 ; exact[1] = exact[2] = exact[3] = 0 ;
+	differ = largest = 0 ;
+	worst = 0 ;
+	frames = 0 ;
+	for (frame = 0; frame < FRAMES; frame++)
+		{
+		Frame(&orientation, &step, &frames, &mesh, &screen, &cube) ;
+		Exact(exact, qstep) ;
+		for (k = 0; k < cube.count; k++)
+			{
+			Reference(&rx, &ry, &orientation, S_FLOAT(cube.x[k]), S_FLOAT(cube.y[k]), S_FLOAT(cube.z[k])) ;
+			dx = abs(screen.x[k] - rx) ;
+			dy = abs(screen.y[k] - ry) ;
+			if (dx != 0 || dy != 0) differ++ ;
+			if (dx > largest) largest = dx ;
+			if (dy > largest) largest = dy ;
+			}
+		dot = fabs(exact[0]*S_FLOAT(orientation.w) + exact[1]*S_FLOAT(orientation.x)
+			+ exact[2]*S_FLOAT(orientation.y) + exact[3]*S_FLOAT(orientation.z)) ;
+		drift = 2 * acos(dot > 1 ? 1 : dot) * 180 / 3.14159265358979 ;
+		if (drift > worst) worst = drift ;
+		}
+
+#ifdef FIXED_POINT
+	printf("Q16 transform, %u frames\n", FRAMES) ;
+#else
+	printf("float transform, %u frames\n", FRAMES) ;
+#endif
+	printf("  positions off by a pixel or more: %u of %u, largest %d\n", differ, FRAMES * cube.count, largest) ;
+	printf("  orientation drift: %.4f degrees at most\n", worst) ;
+
+	// Time per frame for the cube and for a full mesh
+	for (k = 0; k < MESH_MAX_VERTICES; k++)
+		{
+		big.x[k] = cube.x[k % 8] / 2 ;
+		big.y[k] = cube.y[k % 8] / 2 ;
+		big.z[k] = cube.z[k % 8] / 2 ;
+		}
+	big.count = MESH_MAX_VERTICES ;
+
+	printf("  %u vertices: %.1f ns/frame\n", cube.count, (double) HarnessBest(SpinCube, 5) / FRAMES) ;
+	printf("  %u vertices: %.1f ns/frame\n", big.count, (double) HarnessBest(SpinBig, 5) / REPS) ;
+	return 0 ;
+	}
+
+static void SpinBig(void)
+	{
+	uint32_t frame ;
+
+	for (frame = 0; frame < REPS; frame++) Frame(&orientation, &step, &frames, &mesh, &screen, &big) ;
+	}
+
+static void SpinCube(void)
+	{
+	uint32_t frame ;
+
+	for (frame = 0; frame < FRAMES; frame++) Frame(&orientation, &step, &frames, &mesh, &screen, &cube) ;
+	}
+
+// What Lab 5 does each frame
+static void Frame(QUAT *orientation, const QUAT *step, uint32_t *frames, MESH *mesh, MESH_SCREEN *screen, const MESH *model)
+	{
+	SCALAR matrix[3][3] ;
+
+	QuatMultiply(orientation, step, orientation) ;
+	if (++*frames == RENORMALIZE)
+		{
+		QuatNormalize(orientation) ;
+		*frames = 0 ;
+		}
+	QuatToMatrix(matrix, orientation) ;
+	MeshTransform(mesh, screen, model, (void *) matrix, &view) ;
+	}
+
+static void Exact(double q[4], const double step[4])
+	{
+	double w, x, y, z ;
+
+	w = step[0]*q[0] - step[1]*q[1] - step[2]*q[2] - step[3]*q[3] ;
+	x = step[0]*q[1] + step[1]*q[0] + step[2]*q[3] - step[3]*q[2] ;
+	y = step[0]*q[2] - step[1]*q[3] + step[2]*q[0] + step[3]*q[1] ;
+	z = step[0]*q[3] + step[1]*q[2] - step[2]*q[1] + step[3]*q[0] ;
+	q[0] = w ; q[1] = x ; q[2] = y ; q[3] = z ;
+	}
+
+static void Reference(int16_t *sx, int16_t *sy, const QUAT *q, double x, double y, double z)
+	{
+	double w = S_FLOAT(q->w), qx = S_FLOAT(q->x), qy = S_FLOAT(q->y), qz = S_FLOAT(q->z) ;
+	double n = sqrt(w*w + qx*qx + qy*qy + qz*qz) ;
+	double tx, ty ;
+
+	w /= n ; qx /= n ; qy /= n ; qz /= n ;
+	tx = (1 - 2*(qy*qy + qz*qz))*x + 2*(qx*qy - w*qz)*y + 2*(qx*qz + w*qy)*z ;
+	ty = 2*(qx*qy + w*qz)*x + (1 - 2*(qx*qx + qz*qz))*y + 2*(qy*qz - w*qx)*z ;
+	*sx = (int16_t) (S_FLOAT(view.xCenter) + S_FLOAT(view.scale)*tx) ;
+	*sy = (int16_t) (S_FLOAT(view.yCenter) + S_FLOAT(view.scale)*ty) ;
+	}
+
+#endif
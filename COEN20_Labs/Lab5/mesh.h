@@ -0,0 +1,52 @@
+/*
+	Vertex processing for Lab 5 meshes.
+
+	A MESH keeps its vertices as a structure of arrays: all the x's,
+	then all the y's, then all the z's. Triangles refer to vertices by
+	index, so a vertex shared by several triangles is transformed once.
+	MeshTransform applies one matrix to every vertex and, in the same
+	pass, works out the screen position of each.
+
+	Coordinates are SCALARs (see scalar.h), so defining FIXED_POINT
+	moves the whole transform to Q16. A host build of mesh.c with
+	MESH_BENCH defined spins the Lab 5 cube, checks every screen position
+	against a double-precision reference and reports time per frame;
+	build it both ways to compare:
+
+		gcc -O2 -I../Common -DMESH_BENCH -o mesh mesh.c quat.c ../Common/fixmath.c ../Common/harness.c -lm && ./mesh
+		gcc -O2 -I../Common -DMESH_BENCH -DFIXED_POINT -o mesh mesh.c quat.c ../Common/fixmath.c ../Common/harness.c -lm && ./mesh
+*/
+
+#ifndef MESH_H
+#define	MESH_H
+
+#include <stdint.h>
+#include "scalar.h"
+
+#define	MESH_MAX_VERTICES	256
+
+typedef struct
+	{
+	uint32_t			count ;
+	SCALAR				x[MESH_MAX_VERTICES] ;
+	SCALAR				y[MESH_MAX_VERTICES] ;
+	SCALAR				z[MESH_MAX_VERTICES] ;
+	} MESH ;
+
+typedef struct
+	{
+	int16_t				x[MESH_MAX_VERTICES] ;	// Column
+	int16_t				y[MESH_MAX_VERTICES] ;	// Row
+	} MESH_SCREEN ;
+
+typedef struct
+	{
+	SCALAR				scale ;		// Pixels per unit
+	SCALAR				xCenter ;	// Screen position of the origin
+	SCALAR				yCenter ;
+	} MESH_VIEW ;
+
+// dst may be the same mesh as src
+extern void				MeshTransform(MESH *dst, MESH_SCREEN *screen, const MESH *src, const SCALAR matrix[3][3], const MESH_VIEW *view) ;
+
+#endif
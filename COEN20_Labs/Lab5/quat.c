@@ -0,0 +1,95 @@
+/*
+	Unit quaternions.
+
+	QuatFromMatrix uses Shepperd's method: it solves for whichever of
+	w, x, y and z is largest first, so it never divides by a number
+	near zero. QuatNormalize is meant to be called often, while the
+	length is still within rounding error of 1, so one Newton step for
+	1/sqrt(n) starting from 1, (3 - n)/2, is as good as the square root
+	and costs no division. Every component of a unit quaternion and of
+	a rotation matrix lies within -1 to +1, so no intermediate here can
+	overflow Q16.
+*/
+
+#include "quat.h"
+
+void QuatIdentity(QUAT *q)
+	{
+	q->w = S_CONST(1.0) ;
+	q->x = q->y = q->z = S_CONST(0.0) ;
+	}
+
+void QuatFromMatrix(QUAT *q, const SCALAR m[3][3])
+	{
+	SCALAR trace, s ;
+
+	trace = m[0][0] + m[1][1] + m[2][2] ;
+	if (trace > 0)
+		{
+		s = 2 * S_SQRT(S_CONST(1.0) + trace) ;			// 4w
+		q->w = s / 4 ;
+		q->x = S_DIV(m[2][1] - m[1][2], s) ;
+		q->y = S_DIV(m[0][2] - m[2][0], s) ;
+		q->z = S_DIV(m[1][0] - m[0][1], s) ;
+		}
+	else if (m[0][0] > m[1][1] && m[0][0] > m[2][2])
+		{
+		s = 2 * S_SQRT(S_CONST(1.0) + m[0][0] - m[1][1] - m[2][2]) ;	// 4x
+		q->w = S_DIV(m[2][1] - m[1][2], s) ;
+		q->x = s / 4 ;
+		q->y = S_DIV(m[0][1] + m[1][0], s) ;
+		q->z = S_DIV(m[0][2] + m[2][0], s) ;
+		}
+	else if (m[1][1] > m[2][2])
+		{
+		s = 2 * S_SQRT(S_CONST(1.0) + m[1][1] - m[0][0] - m[2][2]) ;	// 4y
+		q->w = S_DIV(m[0][2] - m[2][0], s) ;
+		q->x = S_DIV(m[0][1] + m[1][0], s) ;
+		q->y = s / 4 ;
+		q->z = S_DIV(m[1][2] + m[2][1], s) ;
+		}
+	else
+		{
+		s = 2 * S_SQRT(S_CONST(1.0) + m[2][2] - m[0][0] - m[1][1]) ;	// 4z
+		q->w = S_DIV(m[1][0] - m[0][1], s) ;
+		q->x = S_DIV(m[0][2] + m[2][0], s) ;
+		q->y = S_DIV(m[1][2] + m[2][1], s) ;
+		q->z = s / 4 ;
+		}
+	QuatNormalize(q) ;
+	}
+
+void QuatMultiply(QUAT *a, const QUAT *b, const QUAT *c)
+	{
+	QUAT q ;
+
+	q.w = S_MUL(b->w, c->w) - S_MUL(b->x, c->x) - S_MUL(b->y, c->y) - S_MUL(b->z, c->z) ;
+	q.x = S_MUL(b->w, c->x) + S_MUL(b->x, c->w) + S_MUL(b->y, c->z) - S_MUL(b->z, c->y) ;
+	q.y = S_MUL(b->w, c->y) - S_MUL(b->x, c->z) + S_MUL(b->y, c->w) + S_MUL(b->z, c->x) ;
+	q.z = S_MUL(b->w, c->z) + S_MUL(b->x, c->y) - S_MUL(b->y, c->x) + S_MUL(b->z, c->w) ;
+	*a = q ;
+	}
+
+void QuatNormalize(QUAT *q)
+	{
+	SCALAR n, s ;
+
+	n = S_MUL(q->w, q->w) + S_MUL(q->x, q->x) + S_MUL(q->y, q->y) + S_MUL(q->z, q->z) ;
+	s = (S_CONST(3.0) - n) / 2 ;
+	q->w = S_MUL(q->w, s) ;
+	q->x = S_MUL(q->x, s) ;
+	q->y = S_MUL(q->y, s) ;
+	q->z = S_MUL(q->z, s) ;
+	}
+
+void QuatToMatrix(SCALAR m[3][3], const QUAT *q)
+	{
+	SCALAR xx = S_MUL(q->x, q->x), yy = S_MUL(q->y, q->y), zz = S_MUL(q->z, q->z) ;
+	SCALAR xy = S_MUL(q->x, q->y), xz = S_MUL(q->x, q->z), yz = S_MUL(q->y, q->z) ;
+	SCALAR wx = S_MUL(q->w, q->x), wy = S_MUL(q->w, q->y), wz = S_MUL(q->w, q->z) ;
+	SCALAR one = S_CONST(1.0) ;
+
+	m[0][0] = one - 2*(yy + zz) ;	m[0][1] = 2*(xy - wz) ;			m[0][2] = 2*(xz + wy) ;
+	m[1][0] = 2*(xy + wz) ;			m[1][1] = one - 2*(xx + zz) ;	m[1][2] = 2*(yz - wx) ;
+	m[2][0] = 2*(xz - wy) ;			m[2][1] = 2*(yz + wx) ;			m[2][2] = one - 2*(xx + yy) ;
+	}
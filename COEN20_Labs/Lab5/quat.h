@@ -0,0 +1,31 @@
+/*
+	Unit quaternions for keeping an orientation.
+
+	Composing rotations as quaternions and turning the result into a
+	matrix only when it is needed keeps rounding error from building up
+	in the model: the error that does build up only changes the length
+	of the quaternion, and QuatNormalize puts that right. Matrices are
+	row-major and rotate column vectors, as in Lab 5. Components are
+	SCALARs, so they are Q16 when FIXED_POINT is defined.
+*/
+
+#ifndef QUAT_H
+#define	QUAT_H
+
+#include "scalar.h"
+
+typedef struct
+	{
+	SCALAR				w ;
+	SCALAR				x ;
+	SCALAR				y ;
+	SCALAR				z ;
+	} QUAT ;
+
+extern void				QuatIdentity(QUAT *q) ;
+extern void				QuatFromMatrix(QUAT *q, const SCALAR m[3][3]) ;
+extern void				QuatMultiply(QUAT *a, const QUAT *b, const QUAT *c) ;	// a = b * c; a may be b or c
+extern void				QuatNormalize(QUAT *q) ;
+extern void				QuatToMatrix(SCALAR m[3][3], const QUAT *q) ;
+
+#endif
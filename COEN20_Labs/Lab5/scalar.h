@@ -0,0 +1,57 @@
+/*
+	Number type for the Lab 5 renderer.
+
+	SCALAR is float, or Q16 fixed point (65536 = 1.0) when FIXED_POINT
+	is defined, for parts or builds without an FPU. Code that does its
+	arithmetic through the macros below compiles either way:
+
+		S_CONST(x)		a constant, e.g. S_CONST(-1.0)
+		S_MUL(a, b)		a * b, rounded
+		S_DIV(a, b)		a / b
+		S_INT(s)		s converted to int, truncated toward zero
+		S_FLOAT(s)		s converted to float
+		S_SIN(angle)	sine and cosine of a 16-bit binary angle
+		S_COS(angle)	(0x10000 = one turn), using SinQ15 in Q16
+		S_SQRT(s)		square root of a non-negative s
+
+	Addition, subtraction and multiplying or dividing by an integer
+	need no macro. A Q16 SCALAR covers -32768 to +32767.99998.
+*/
+
+#ifndef SCALAR_H
+#define	SCALAR_H
+
+#include <stdint.h>
+#include "fixmath.h"
+
+#ifdef FIXED_POINT
+
+typedef int32_t			SCALAR ;
+
+#define	S_CONST(x)		((SCALAR) ((x) * 65536.0 + ((x) < 0 ? -0.5 : 0.5)))
+#define	S_MUL(a, b)		((SCALAR) (((int64_t) (a) * (b) + 0x8000) >> 16))
+#define	S_DIV(a, b)		((SCALAR) (((int64_t) (a) * 65536) / (b)))
+#define	S_INT(s)		((s) < 0 ? -(-(s) >> 16) : (s) >> 16)
+#define	S_FLOAT(s)		((float) (s) / 65536)
+#define	S_SIN(angle)	(2 * SinQ15(angle))
+#define	S_COS(angle)	(2 * CosQ15(angle))
+#define	S_SQRT(s)		((SCALAR) SqrtQ16(s))
+
+#else
+
+#include <math.h>
+
+typedef float			SCALAR ;
+
+#define	S_CONST(x)		((SCALAR) (x))
+#define	S_MUL(a, b)		((a) * (b))
+#define	S_DIV(a, b)		((a) / (b))
+#define	S_INT(s)		((int) (s))
+#define	S_FLOAT(s)		((float) (s))
+#define	S_SIN(angle)	sinf((angle) * (float) (2 * 3.14159265358979 / 65536))
+#define	S_COS(angle)	cosf((angle) * (float) (2 * 3.14159265358979 / 65536))
+#define	S_SQRT(s)		sqrtf(s)
+
+#endif
+
+#endif